@@ -1,14 +1,28 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
+// True when slot 0 holds a signed distance field atlas rather than coverage
+layout (constant_id = 0) const bool distanceFieldFont = false;
+
 layout (binding = 0) uniform sampler2D fontSampler;
 
 layout (location = 0) in vec2 inUV;
 layout (location = 1) in vec4 inColor;
+layout (location = 2) flat in uint inTexture;
 
 layout (location = 0) out vec4 outColor;
 
 void main() 
 {
-	outColor = inColor * texture(fontSampler, inUV);
+	vec4 texel = texture(fontSampler, inUV);
+
+	// The edge sits at 0.5, widening the step by the screen space derivative keeps it one pixel wide at any scale
+	float edge = max(0.5 * fwidth(texel.a), 1.0 / 512.0);
+
+	if (distanceFieldFont && inTexture == 0u)
+	{
+		texel.a = smoothstep(0.5 - edge, 0.5 + edge, texel.a);
+	}
+
+	outColor = inColor * texel;
 }
\ No newline at end of file
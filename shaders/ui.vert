@@ -12,6 +12,7 @@ layout (push_constant) uniform PushConstants {
 
 layout (location = 0) out vec2 outUV;
 layout (location = 1) out vec4 outColor;
+layout (location = 2) flat out uint outTexture;
 
 out gl_PerVertex 
 {
@@ -20,7 +21,9 @@ out gl_PerVertex
 
 void main() 
 {
+	// Each draw carries its texture slot in firstInstance
 	outUV = inUV;
 	outColor = inColor;
+	outTexture = gl_InstanceIndex;
 	gl_Position = vec4(inPos * pushConstants.scale + pushConstants.translate, 0.0, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,13 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// Cached UI layer, premultiplied alpha
+layout (binding = 0) uniform sampler2D layerSampler;
+
+layout (location = 0) out vec4 outColor;
+
+void main()
+{
+	// The layer matches the framebuffer 1:1, so fetch the texel under this pixel without filtering
+	outColor = texelFetch(layerSampler, ivec2(gl_FragCoord.xy), 0);
+}
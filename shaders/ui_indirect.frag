@@ -0,0 +1,33 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (constant_id = 0) const bool distanceFieldFont = false;
+
+layout (binding = 0) uniform sampler2D fontSampler;
+
+layout (location = 0) in vec2 inUV;
+layout (location = 1) in vec4 inColor;
+layout (location = 2) flat in vec4 inClipRect;
+layout (location = 3) flat in uint inTexture;
+
+layout (location = 0) out vec4 outColor;
+
+void main() 
+{
+	// Replaces the per draw scissor, clip rect is (min.x, min.y, max.x, max.y) in framebuffer pixels
+	if (gl_FragCoord.x < inClipRect.x || gl_FragCoord.y < inClipRect.y ||
+		gl_FragCoord.x >= inClipRect.z || gl_FragCoord.y >= inClipRect.w)
+	{
+		discard;
+	}
+
+	vec4  texel = texture(fontSampler, inUV);
+	float edge  = max(0.5 * fwidth(texel.a), 1.0 / 512.0);
+
+	if (distanceFieldFont && inTexture == 0u)
+	{
+		texel.a = smoothstep(0.5 - edge, 0.5 + edge, texel.a);
+	}
+
+	outColor = inColor * texel;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (location = 0) in vec2 inPos;
+layout (location = 1) in vec2 inUV;
+layout (location = 2) in vec4 inColor;
+
+layout (push_constant) uniform PushConstants {
+	vec2 scale;
+	vec2 translate;
+} pushConstants;
+
+struct DrawData {
+	vec4 clipRect;
+	uvec4 texture; // x is the bindless texture slot
+};
+
+// One entry per indirect draw, indexed through the draw's firstInstance
+layout (std430, set = 1, binding = 0) readonly buffer Draws {
+	DrawData draws[];
+};
+
+layout (location = 0) out vec2 outUV;
+layout (location = 1) out vec4 outColor;
+layout (location = 2) flat out vec4 outClipRect;
+layout (location = 3) flat out uint outTexture;
+
+out gl_PerVertex 
+{
+	vec4 gl_Position;   
+};
+
+void main() 
+{
+	outUV = inUV;
+	outColor = inColor;
+	outClipRect = draws[gl_InstanceIndex].clipRect;
+	outTexture = draws[gl_InstanceIndex].texture.x;
+	gl_Position = vec4(inPos * pushConstants.scale + pushConstants.translate, 0.0, 1.0);
+}
\ No newline at end of file
@@ -3,13 +3,16 @@
 extern VkGen::VkGenerator g_VkGenerator;
 extern Logger             g_Logger;
 
-bool VkApp::m_force_close = false;
+bool VkApp::m_force_close      = false;
+bool VkApp::m_redraw_requested = false;
 
 void VkApp::Start()
 {
 	m_input_manager.InitialiseInput(g_VkGenerator.WindowHdle());
 	g_VkGenerator.DisplayWindow(true);
 	glfwSetWindowCloseCallback(g_VkGenerator.WindowHdle(), &WindowCloseCallback);
+	glfwSetWindowRefreshCallback(g_VkGenerator.WindowHdle(), &WindowRefreshCallback);
+	glfwSetFramebufferSizeCallback(g_VkGenerator.WindowHdle(), &FramebufferSizeCallback);
 
 #ifdef _DEBUG
 	const int x = glfwGetVideoMode(glfwGetPrimaryMonitor())->width;
@@ -45,6 +48,45 @@ void VkApp::WindowCloseCallback(GLFWwindow* _window)
 	m_force_close = true;
 }
 
+void VkApp::WindowRefreshCallback(GLFWwindow* _window)
+{
+	m_redraw_requested = true;
+}
+
+void VkApp::FramebufferSizeCallback(GLFWwindow* _window, int _width, int _height)
+{
+	m_redraw_requested = true;
+}
+
+void VkApp::WaitEvents(double _timeout)
+{
+	if (_timeout > 0.0)
+	{
+		glfwWaitEventsTimeout(_timeout);
+	}
+	else
+	{
+		glfwWaitEvents();
+	}
+}
+
+bool VkApp::InputReceived()
+{
+	return m_input_manager.ConsumeInputReceived();
+}
+
+bool VkApp::RedrawRequested()
+{
+	const bool requested = m_redraw_requested;
+	m_redraw_requested   = false;
+	return requested;
+}
+
+bool VkApp::Minimised() const
+{
+	return glfwGetWindowAttrib(g_VkGenerator.WindowHdle(), GLFW_ICONIFIED) != 0;
+}
+
 bool VkApp::ShouldStop()
 {
 	if (m_force_close)
@@ -0,0 +1,401 @@
+#include "include\GlyphCache.h"
+#include "include\imgui-1.70\imgui_internal.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+// imgui_draw.cpp keeps its copy static as well, so the two never collide at link time
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "include\imgui-1.70\imstb_truetype.h"
+
+GlyphCache::GlyphCache() = default;
+
+GlyphCache::~GlyphCache() = default;
+
+bool GlyphCache::Load(const std::string& _file, float _size_pixels, uint32_t _glyph_budget)
+{
+	m_font = nullptr;
+	m_font_data.clear();
+	m_cached.clear();
+	m_missing.clear();
+
+	std::ifstream file(_file, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	m_font_data.resize(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(m_font_data.data()), m_font_data.size());
+
+	m_info = std::make_unique<stbtt_fontinfo>();
+	if (!stbtt_InitFont(m_info.get(), m_font_data.data(), stbtt_GetFontOffsetForIndex(m_font_data.data(), 0)))
+	{
+		m_font_data.clear();
+		return false;
+	}
+
+	m_size_pixels  = _size_pixels;
+	m_glyph_budget = std::max(_glyph_budget, 1u);
+
+	return true;
+}
+
+void GlyphCache::AddToAtlas(ImFontAtlas* _atlas, const ImWchar* _base_ranges, uint32_t _bytes_per_pixel)
+{
+	assert(("No font loaded for the glyph cache", !m_font_data.empty()));
+
+	// A new ImGui context starts with an empty font, so everything cached so far is queued again
+	m_requested.insert(m_requested.end(), m_cached.begin(), m_cached.end());
+	m_cached.clear();
+	m_dirty.clear();
+	m_bytes_per_pixel = _bytes_per_pixel;
+	m_glyph_count     = 0;
+	m_shelf_x         = k_padding;
+	m_shelf_y         = k_padding;
+	m_shelf_height    = 0;
+	m_full            = false;
+
+	// ImGui can only bake coverage, so a distance field font bakes just a space and the base ranges go
+	// through the cache like every other glyph
+	static const ImWchar k_space_range[] = {0x0020, 0x0020, 0};
+
+	const float    size_pixels = m_distance_field ?
+		                             m_size_pixels * k_distance_field_scale :
+		                             m_size_pixels;
+	const ImWchar* ranges      = _base_ranges;
+
+	// One square cell per glyph of the budget, a distance field also carries its padding on both sides
+	const uint32_t cell    = static_cast<uint32_t>(std::ceil(size_pixels)) + k_padding +
+		(m_distance_field ? 2 * k_field_padding : 0);
+	const uint32_t columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(m_glyph_budget))));
+
+	m_region_size = std::max(columns * cell + k_padding, k_min_region_size);
+	m_pixels.assign(m_region_size * m_region_size * m_bytes_per_pixel, 0);
+
+	if (m_distance_field)
+	{
+		for (const ImWchar* range = _base_ranges ; range[0] != 0 ; range += 2)
+		{
+			for (uint32_t codepoint = range[0] ; codepoint <= range[1] ; ++codepoint)
+			{
+				m_requested.push_back(static_cast<ImWchar>(codepoint));
+			}
+		}
+
+		ranges = k_space_range;
+	}
+
+	m_scale = stbtt_ScaleForPixelHeight(m_info.get(), size_pixels);
+
+	// Matches the stb path of the atlas builder so cached glyphs line up with the baked ones
+	ImFontConfig config;
+	config.FontDataOwnedByAtlas = false;
+	config.OversampleH          = 1;
+	config.OversampleV          = 1;
+	config.PixelSnapH           = true;
+
+	m_font = _atlas->AddFontFromMemoryTTF(m_font_data.data(),
+	                                      static_cast<int>(m_font_data.size()),
+	                                      size_pixels,
+	                                      &config,
+	                                      ranges);
+
+	if (m_distance_field)
+	{
+		m_font->Scale = 1.0f / k_distance_field_scale;
+	}
+
+	// The builder sizes the width from glyphs alone, at least 512. Only a region wider than that needs it raised
+	const int region_width = static_cast<int>(m_region_size) + 2 * _atlas->TexGlyphPadding;
+	if (region_width > 512 && _atlas->TexDesiredWidth < region_width)
+	{
+		int width = 512;
+		while (width < region_width)
+		{
+			width *= 2;
+		}
+
+		_atlas->TexDesiredWidth = width;
+	}
+
+	m_rect_index = _atlas->AddCustomRectRegular(k_rect_id, m_region_size, m_region_size);
+}
+
+void GlyphCache::OnAtlasBuilt(ImFontAtlas* _atlas)
+{
+	const ImFontAtlas::CustomRect* rect = _atlas->GetCustomRectByIndex(m_rect_index);
+	assert(("Glyph cache region was not packed", rect != nullptr && rect->IsPacked()));
+
+	m_region_x     = rect->X;
+	m_region_y     = rect->Y;
+	m_atlas_width  = static_cast<uint32_t>(_atlas->TexWidth);
+	m_atlas_height = static_cast<uint32_t>(_atlas->TexHeight);
+	m_offset_y     = static_cast<float>(static_cast<int>(m_font->Ascent + 0.5f)) + m_font->ConfigData->GlyphOffset.y;
+}
+
+void GlyphCache::Request(ImWchar _codepoint)
+{
+	// Most captured text is already in the font, so the lookup keeps the per frame cost to the text itself
+	if (m_font != nullptr && !m_full &&
+		m_font->FindGlyphNoFallback(_codepoint) == nullptr && m_missing.count(_codepoint) == 0)
+	{
+		m_requested.push_back(_codepoint);
+	}
+}
+
+void GlyphCache::Request(const char* _text, const char* _text_end)
+{
+	const char* text = _text;
+
+	while ((_text_end == nullptr || text < _text_end) && *text != 0)
+	{
+		unsigned int codepoint = 0;
+		text += ImTextCharFromUtf8(&codepoint, text, _text_end);
+
+		if (codepoint == 0)
+		{
+			break;
+		}
+
+		// ImWchar is 16 bit, anything outside the BMP cannot be stored in the font
+		if (codepoint < 0x10000)
+		{
+			Request(static_cast<ImWchar>(codepoint));
+		}
+	}
+}
+
+void GlyphCache::BeginCapture()
+{
+	ImGuiContext& g = *ImGui::GetCurrentContext();
+
+	if (m_font == nullptr || m_full || g.LogEnabled)
+	{
+		return;
+	}
+
+	// Every string RenderText lays out is appended to the log. A depth of 0 keeps it from opening tree nodes,
+	// the previous depth is put back afterwards for logs the application starts itself
+	m_log_depth = g.LogAutoExpandMaxDepth;
+	m_capturing = true;
+	ImGui::LogToClipboard(0);
+}
+
+void GlyphCache::EndCapture()
+{
+	if (!m_capturing)
+	{
+		return;
+	}
+
+	ImGuiIO&   io             = ImGui::GetIO();
+	const auto set_clipboard  = io.SetClipboardTextFn;
+	void*      clipboard_data = io.ClipboardUserData;
+
+	// LogFinish hands the whole log to the clipboard callback, which is pointed here for the one call
+	io.SetClipboardTextFn = [](void* _user_data, const char* _text)
+	{
+		static_cast<GlyphCache*>(_user_data)->Request(_text);
+	};
+	io.ClipboardUserData = this;
+
+	ImGui::LogFinish();
+
+	io.SetClipboardTextFn = set_clipboard;
+	io.ClipboardUserData  = clipboard_data;
+
+	ImGui::GetCurrentContext()->LogAutoExpandMaxDepth = m_log_depth;
+	m_capturing                                       = false;
+}
+
+bool GlyphCache::Update()
+{
+	if (m_font == nullptr || m_requested.empty())
+	{
+		return false;
+	}
+
+	// The lookup table is only rebuilt after the batch, so duplicates have to go first
+	std::sort(m_requested.begin(), m_requested.end());
+	m_requested.erase(std::unique(m_requested.begin(), m_requested.end()), m_requested.end());
+
+	bool added = false;
+
+	for (const ImWchar codepoint : m_requested)
+	{
+		if (m_full)
+		{
+			break;
+		}
+
+		if (m_font->FindGlyphNoFallback(codepoint) != nullptr || m_missing.count(codepoint) != 0)
+		{
+			continue;
+		}
+
+		added |= Rasterize(codepoint);
+	}
+
+	m_requested.clear();
+
+	if (added)
+	{
+		m_font->BuildLookupTable();
+	}
+
+	return added;
+}
+
+void GlyphCache::MarkAllDirty()
+{
+	const uint32_t used_height = std::min(m_shelf_y + m_shelf_height, m_region_size);
+
+	m_dirty.clear();
+	if (m_glyph_count > 0)
+	{
+		m_dirty.push_back({0, 0, m_region_size, used_height});
+	}
+}
+
+bool GlyphCache::Rasterize(ImWchar _codepoint)
+{
+	const int glyph = stbtt_FindGlyphIndex(m_info.get(), _codepoint);
+	if (glyph == 0)
+	{
+		m_missing.insert(_codepoint);
+		return false;
+	}
+
+	int advance, left_bearing;
+	stbtt_GetGlyphHMetrics(m_info.get(), glyph, &advance, &left_bearing);
+
+	int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+
+	if (m_distance_field)
+	{
+		int            field_width  = 0;
+		int            field_height = 0;
+		unsigned char* field        = stbtt_GetGlyphSDF(m_info.get(), m_scale, glyph, k_field_padding, k_field_edge,
+		                                                static_cast<float>(k_field_edge) / k_field_padding,
+		                                                &field_width, &field_height, &x0, &y0);
+
+		if (field != nullptr)
+		{
+			m_scratch.assign(field, field + field_width * field_height);
+			stbtt_FreeSDF(field, nullptr);
+		}
+
+		x1 = x0 + field_width;
+		y1 = y0 + field_height;
+	}
+	else
+	{
+		stbtt_GetGlyphBitmapBox(m_info.get(), glyph, m_scale, m_scale, &x0, &y0, &x1, &y1);
+
+		m_scratch.resize((x1 - x0) * (y1 - y0));
+		stbtt_MakeGlyphBitmap(m_info.get(), m_scratch.data(), x1 - x0, y1 - y0, x1 - x0, m_scale, m_scale, glyph);
+	}
+
+	const uint32_t width  = static_cast<uint32_t>(x1 - x0);
+	const uint32_t height = static_cast<uint32_t>(y1 - y0);
+	uint32_t       x      = 0;
+	uint32_t       y      = 0;
+
+	// Blank glyphs such as spaces only need metrics
+	if (width > 0 && height > 0)
+	{
+		if (!Allocate(width, height, x, y))
+		{
+			m_full = true;
+			return false;
+		}
+
+		for (uint32_t row = 0 ; row < height ; ++row)
+		{
+			const uint8_t* src = m_scratch.data() + row * width;
+			uint8_t*       dst = m_pixels.data() + ((y + row) * m_region_size + x) * m_bytes_per_pixel;
+
+			if (m_bytes_per_pixel == 1)
+			{
+				std::memcpy(dst, src, width);
+				continue;
+			}
+
+			// Same expansion GetTexDataAsRGBA32 applies to the baked glyphs, white with coverage in alpha
+			for (uint32_t column = 0 ; column < width ; ++column)
+			{
+				dst[column * 4 + 0] = 0xFF;
+				dst[column * 4 + 1] = 0xFF;
+				dst[column * 4 + 2] = 0xFF;
+				dst[column * 4 + 3] = src[column];
+			}
+		}
+
+		AddDirty({x, y, width, height});
+	}
+
+	const float u0 = static_cast<float>(m_region_x + x) / m_atlas_width;
+	const float v0 = static_cast<float>(m_region_y + y) / m_atlas_height;
+	const float u1 = static_cast<float>(m_region_x + x + width) / m_atlas_width;
+	const float v1 = static_cast<float>(m_region_y + y + height) / m_atlas_height;
+
+	m_font->AddGlyph(_codepoint,
+	                 static_cast<float>(x0),
+	                 static_cast<float>(y0) + m_offset_y,
+	                 static_cast<float>(x1),
+	                 static_cast<float>(y1) + m_offset_y,
+	                 u0, v0, u1, v1,
+	                 advance * m_scale);
+
+	m_cached.push_back(_codepoint);
+	++m_glyph_count;
+
+	return true;
+}
+
+bool GlyphCache::Allocate(uint32_t _width, uint32_t _height, uint32_t& _x, uint32_t& _y)
+{
+	if (m_shelf_x + _width + k_padding > m_region_size)
+	{
+		m_shelf_x      = k_padding;
+		m_shelf_y     += m_shelf_height;
+		m_shelf_height = 0;
+	}
+
+	if (m_shelf_y + _height + k_padding > m_region_size || _width + 2 * k_padding > m_region_size)
+	{
+		return false;
+	}
+
+	_x = m_shelf_x;
+	_y = m_shelf_y;
+
+	m_shelf_x     += _width + k_padding;
+	m_shelf_height = std::max(m_shelf_height, _height + k_padding);
+
+	return true;
+}
+
+void GlyphCache::AddDirty(const Rect& _rect)
+{
+	// Neighbours on the same shelf become one copy region, padding between them included
+	if (!m_dirty.empty())
+	{
+		Rect& last = m_dirty.back();
+
+		if (last.y == _rect.y && last.x + last.width + k_padding == _rect.x)
+		{
+			last.width += k_padding + _rect.width;
+			last.height = std::max(last.height, _rect.height);
+			return;
+		}
+	}
+
+	m_dirty.push_back(_rect);
+}
@@ -3,11 +3,19 @@
 extern VkGen::VkGenerator g_VkGenerator;
 extern Logger             g_Logger;
 
+// Idle mode sleeps once this many frames passed without input, ImGui needs a few to settle after the last event
+constexpr uint32_t k_idle_quiet_frames = 3;
+
+// Longest idle sleep, keeps time driven content such as the clock and the text caret ticking over
+constexpr double k_idle_timeout = 0.25;
+
 void VkImguiDemo::Setup()
 {
+	CaptureRenderSettings();
 	CreateSwapchain();
 	CreateCmdPool();
 	CreateCmdBuffers();
+	CreateSecondaryCmdBuffers();
 	CreateColourResources();
 	CreateDepthResources(); // Not created for this program
 	CreateRenderPasses();
@@ -16,13 +24,13 @@ void VkImguiDemo::Setup()
 	CreatePipelines();
 	CreateSyncObjects();
 
-	const bool msaa = Settings::Instance()->use_msaa;
-
+	m_ui_instance.SetScheduler(&m_scheduler);
 	m_ui_instance.Init(m_swapchain.Extent().width, m_swapchain.Extent().height, g_VkGenerator.WindowHdle());
 	m_ui_instance.LoadResources(g_VkGenerator.Device(), g_VkGenerator.PhysicalDevice(), m_shader_directory, m_command,
-	                            m_render_pass.Pass(), g_VkGenerator.GraphicsQueue(), msaa ?
-		                                                                                 Settings::Instance()->GetSampleCount() :
-		                                                                                 vk::SampleCountFlagBits::e1);
+	                            m_render_pass.Pass(), g_VkGenerator.GraphicsQueue(), vk::SampleCountFlagBits::e1,
+	                            MAX_FRAMES_IN_FLIGHT, m_ui_subpass);
+
+	m_incremental_present = g_VkGenerator.DeviceExtensionEnabled(VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME);
 
 	m_app_instance.SetWindowTitle("Vulkan ImGui Triangle Demo");
 	m_app_instance.Start();
@@ -33,34 +41,257 @@ void VkImguiDemo::Run()
 	float init_time      = 0.0f;
 	bool  stop_execution = false;
 
+	StartRenderThread();
+
 	while (!stop_execution)
 	{
+		// A minimised window has nothing to present, sleep until it is restored
+		if (m_app_instance.Minimised())
+		{
+			m_app_instance.WaitEvents();
+			stop_execution = m_app_instance.ShouldStop();
+			continue;
+		}
+
+		if (Settings::Instance()->idle_mode && m_quiet_frames >= k_idle_quiet_frames)
+		{
+			m_app_instance.WaitEvents(k_idle_timeout);
+		}
+
+		// The render thread still reads the other snapshot until it takes the last published one. Waiting before the
+		// input is polled rather than before publishing keeps the frame it takes next as fresh as possible
+		{
+			std::unique_lock<std::mutex> lock(m_render_mutex);
+			m_render_wake.wait(lock, [this]
+			{
+				return !m_frame_published;
+			});
+		}
+
 		m_total_time  = static_cast<float>(glfwGetTime());
 		m_frame_delta = m_total_time - init_time;
 		init_time     = m_total_time;
 
+		// GLFW only takes input on the main thread, so polling and building the UI stay here while the render thread
+		// records, submits and presents the previous frame
 		m_app_instance.Update(m_frame_delta);
+
 		stop_execution     = m_app_instance.ShouldStop();
 		m_settings_updated = Settings::Instance()->Updated(true);
+		const bool input   = m_app_instance.InputReceived();
+		m_quiet_frames     = input ?
+			                     0 :
+			                     m_quiet_frames + 1;
 
-		if (m_settings_updated)
+		if (m_app_instance.RedrawRequested())
 		{
-			const bool msaa = Settings::Instance()->use_msaa;
+			m_presented_hash = 0;
+		}
 
+		// A skipped frame or a rebuilt swapchain left the screen behind what was last published
+		if (m_redraw_needed.exchange(false))
+		{
+			m_presented_hash = 0;
+		}
+
+		if (m_settings_updated || m_rebuild_needed.exchange(false))
+		{
+			// Rebuilt with the device to ourselves
+			StopRenderThread();
+
+			CaptureRenderSettings();
 			RecreateSwapchain();
+			m_recreate_pending = false;
 			m_ui_instance.Destroy(g_VkGenerator.Device());
 			m_ui_instance.Recreate(g_VkGenerator.Device(), m_swapchain.Extent().width, m_swapchain.Extent().height, g_VkGenerator.WindowHdle());
 			m_ui_instance.LoadResources(g_VkGenerator.Device(), g_VkGenerator.PhysicalDevice(), m_shader_directory, m_command,
-			                            m_render_pass.Pass(), g_VkGenerator.GraphicsQueue(), msaa ?
-				                                                                                 Settings::Instance()->
-				                                                                                 GetSampleCount() :
-				                                                                                 vk::SampleCountFlagBits::e1);
+			                            m_render_pass.Pass(), g_VkGenerator.GraphicsQueue(), vk::SampleCountFlagBits::e1,
+			                            MAX_FRAMES_IN_FLIGHT, m_ui_subpass);
+
+			StartRenderThread();
 
 			m_settings_updated = !m_settings_updated;
 		}
 
-		RecordCmdBuffer();
-		SubmitQueue();
+		m_ui_instance.PrepNextFrame(m_frame_delta, m_total_time, input);
+
+		// The scene is static, so an unchanged UI means the image on screen is already correct.
+		// Nothing is handed to the render thread, which skips acquire, submit and present entirely
+		if (Settings::Instance()->idle_mode && m_presented_hash != 0 && m_ui_instance.ContentHash() == m_presented_hash)
+		{
+			m_ui_instance.FrameSkipped();
+			continue;
+		}
+
+		// Cleared again if the frame is skipped or the swapchain has to be recreated
+		m_presented_hash = m_ui_instance.ContentHash();
+
+		m_ui_instance.PublishFrame();
+
+		{
+			std::lock_guard<std::mutex> lock(m_render_mutex);
+			m_next_parallel_recording  = Settings::Instance()->parallel_recording;
+			m_next_incremental_present = m_incremental_present && Settings::Instance()->incremental_present;
+			m_frame_published          = true;
+		}
+
+		m_render_wake.notify_all();
+	}
+
+	StopRenderThread();
+}
+
+void VkImguiDemo::StartRenderThread()
+{
+	m_render_stop   = false;
+	m_render_thread = std::thread(&VkImguiDemo::RenderLoop, this);
+}
+
+void VkImguiDemo::StopRenderThread()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_render_mutex);
+		m_render_stop = true;
+	}
+
+	m_render_wake.notify_all();
+
+	if (m_render_thread.joinable())
+	{
+		m_render_thread.join();
+	}
+}
+
+void VkImguiDemo::RenderLoop()
+{
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_render_mutex);
+			m_render_wake.wait(lock, [this]
+			{
+				return m_render_stop || m_frame_published;
+			});
+
+			// A frame published before the stop is still drawn, the main thread is waiting for it to be taken
+			if (!m_frame_published)
+			{
+				return;
+			}
+
+			// Taken under the lock, so the main thread never publishes into the snapshot being taken
+			m_ui_instance.TakeFrame();
+
+			m_frame_published         = false;
+			m_use_parallel_recording  = m_next_parallel_recording;
+			m_use_incremental_present = m_next_incremental_present;
+		}
+
+		m_render_wake.notify_all();
+
+		// Found out of date while acquiring or presenting. A minimised window has no extent to build a swapchain
+		// for, the main thread stops publishing until it is restored
+		if (m_recreate_pending)
+		{
+			g_VkGenerator.RefreshSwapchainDetails();
+
+			const vk::Extent2D extent = g_VkGenerator.SwapchainDetails().capabilities.currentExtent;
+
+			if (extent.width == 0 || extent.height == 0)
+			{
+				m_ui_instance.InvalidateUploads();
+				m_redraw_needed = true;
+				continue;
+			}
+
+			// A new format invalidates the render pass and every pipeline built for it, the UI's included, which only
+			// the main thread can rebuild. Frames are skipped until it has
+			const vk::Format format = VkRes::Swapchain::ChooseSwapchainSurfaceFormat(
+				g_VkGenerator.SwapchainDetails().formats).format;
+
+			if (format != m_swapchain.Format())
+			{
+				m_ui_instance.InvalidateUploads();
+				m_rebuild_needed = true;
+				m_redraw_needed  = true;
+				continue;
+			}
+
+			m_recreate_pending = false;
+			ResizeSwapchain();
+		}
+
+		LaunchFrameGraph();
+		m_jobs->WaitAll();
+
+		// The snapshot never reached the GPU, its glyphs are sent again with the next one
+		if (m_frame_skipped)
+		{
+			m_ui_instance.InvalidateUploads();
+			m_redraw_needed = true;
+		}
+
+		m_ui_instance.SetPipelineTimings(m_jobs->Timings(), m_jobs->WorkerCount());
+	}
+}
+
+void VkImguiDemo::LaunchFrameGraph()
+{
+	m_frame_skipped = false;
+
+	// Acquiring first means only the image that is actually rendered gets a command buffer
+	const auto acquire = m_jobs->Add("Acquire", [this]
+	{
+		m_frame_skipped = !AcquireNextImage();
+	});
+
+	const auto update = m_jobs->Add("UI update", [this]
+	{
+		if (!m_frame_skipped)
+		{
+			UpdateFrame();
+		}
+	});
+
+	const auto primary = m_jobs->Add("Primary", [this]
+	{
+		if (!m_frame_skipped)
+		{
+			RecordCmdBuffer();
+		}
+	});
+
+	const auto submit = m_jobs->Add("Submit", [this]
+	{
+		if (!m_frame_skipped)
+		{
+			SubmitQueue();
+		}
+	});
+
+	m_jobs->Depend(update, acquire);
+	m_jobs->Depend(submit, primary);
+
+	// The scene and every UI chunk get a task, the ones past what this frame needs return straight away
+	for (uint32_t task = 0 ; task < m_frame_pools.ThreadCount() ; ++task)
+	{
+		const auto record = m_jobs->Add(task == 0 ? "Record scene" : "Record UI", [this, task]
+		{
+			RecordSecondaryCmdBuffer(task);
+		});
+
+		m_jobs->Depend(record, update);
+		m_jobs->Depend(primary, record);
+	}
+
+	m_jobs->Launch();
+}
+
+void VkImguiDemo::SetFontFile(const std::string& _file, float _size_pixels, uint32_t _glyph_budget)
+{
+	if (!m_ui_instance.SetDynamicFont(_file, _size_pixels, _glyph_budget))
+	{
+		g_Logger.Warning("Failed to load font " + _file + ", the baked default font is used");
 	}
 }
 
@@ -70,9 +301,10 @@ void VkImguiDemo::Shutdown()
 
 	m_ui_instance.Destroy(g_VkGenerator.Device());
 
+	m_scheduler.Destroy(g_VkGenerator.Device());
+
 	for (int i = 0 ; i < MAX_FRAMES_IN_FLIGHT ; i++)
 	{
-		m_inflight_fences[i].Destroy(g_VkGenerator.Device());
 		m_image_available_semaphores[i].Destroy(g_VkGenerator.Device());
 		m_render_finished_semaphores[i].Destroy(g_VkGenerator.Device());
 	}
@@ -88,6 +320,9 @@ void VkImguiDemo::Shutdown()
 
 	m_render_pass.Destroy(g_VkGenerator.Device());
 	m_backbuffer.Destroy(g_VkGenerator.Device());
+	m_ui_command.Destroy(g_VkGenerator.Device());
+	m_scene_command.Destroy(g_VkGenerator.Device());
+	m_frame_pools.Destroy(g_VkGenerator.Device());
 	m_command.Destroy(g_VkGenerator.Device());
 	m_swapchain.Destroy(g_VkGenerator.Device());
 
@@ -115,33 +350,47 @@ VkBool32 VkImguiDemo::DebugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT
 	return VK_FALSE;
 }
 
-void VkImguiDemo::SubmitQueue()
+bool VkImguiDemo::AcquireNextImage()
 {
-	const auto device                    = g_VkGenerator.Device();
-	const auto fence                     = &m_inflight_fences[m_current_frame].FenceInstance();
-	const auto image_available_semaphore = m_image_available_semaphores[m_current_frame].SemaphoreInstance();
-	const auto graphics_queue            = g_VkGenerator.GraphicsQueue();
-	const auto present_queue             = g_VkGenerator.PresentQueue();
+	const auto device = g_VkGenerator.Device();
+
+	// Only this slot's last submission has to retire before its primary, UI ring slot and UI secondary are
+	// reused, the other frames in flight keep the GPU busy meanwhile
+	m_scheduler.WaitFrame(device, m_current_frame);
+	m_scheduler.Collect(device);
 
-	device.waitForFences(1, fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+	// Everything the slot recorded last time has retired, one reset recycles all of its buffers
+	m_frame_pools.Reset(device, m_current_frame);
 
 	const auto result_val = device.acquireNextImageKHR(m_swapchain.SwapchainInstance(),
 	                                                   std::numeric_limits<uint64_t>::max(),
-	                                                   image_available_semaphore,
+	                                                   m_image_available_semaphores[m_current_frame].SemaphoreInstance(),
 	                                                   nullptr);
-	const uint32_t image_index = result_val.value;
 
+	// Nothing was recorded or submitted, so the slot keeps its value and the next wait on it returns straight away
 	if (result_val.result == vk::Result::eErrorOutOfDateKHR)
 	{
-		RecreateSwapchain();
+		m_recreate_pending = true;
+		return false;
 	}
-	else if (result_val.result != vk::Result::eSuccess && result_val.result == vk::Result::eSuboptimalKHR)
+
+	if (result_val.result != vk::Result::eSuccess && result_val.result != vk::Result::eSuboptimalKHR)
 	{
 		g_Logger.Error("Failed to acquire swapchain image");
-		return;
+		return false;
 	}
 
-	const auto command_buffer = m_command.CommandBuffer(image_index);
+	m_image_index = result_val.value;
+	return true;
+}
+
+void VkImguiDemo::SubmitQueue()
+{
+	const auto device                    = g_VkGenerator.Device();
+	const auto image_available_semaphore = m_image_available_semaphores[m_current_frame].SemaphoreInstance();
+	const auto graphics_queue            = g_VkGenerator.GraphicsQueue();
+	const auto present_queue             = g_VkGenerator.PresentQueue();
+	const auto image_index               = m_image_index;
 
 	vk::PipelineStageFlags waitStages[] = {vk::PipelineStageFlagBits::eColorAttachmentOutput};
 
@@ -151,18 +400,15 @@ void VkImguiDemo::SubmitQueue()
 		&image_available_semaphore,
 		waitStages,
 		1,
-		&command_buffer,
+		&m_primary,
 		1,
 		&m_render_finished_semaphores[m_current_frame].SemaphoreInstance(),
 	};
 
-	const auto fence_reset_result = device.resetFences(1, fence);
-	assert(("Failed to reset fence", fence_reset_result == vk::Result::eSuccess));
+	// Tags the frame's primary, its uploads and anything deferred while it was recorded with the next value
+	m_scheduler.Submit(device, graphics_queue, submit_info, m_current_frame);
 
-	const auto submit_result = graphics_queue.submit(1, &submit_info, *fence);
-	assert(("Failed to submit a draw queue", submit_result == vk::Result::eSuccess));
-
-	const vk::PresentInfoKHR present_info =
+	vk::PresentInfoKHR present_info =
 	{
 		1,
 		&m_render_finished_semaphores[m_current_frame].SemaphoreInstance(),
@@ -171,31 +417,63 @@ void VkImguiDemo::SubmitQueue()
 		&image_index
 	};
 
+	// The scene is static, so the UI's damage is everything that changed since the last present. The image is still
+	// complete, the rect only tells the presentation engine what it can skip
+	vk::RectLayerKHR      present_rect;
+	vk::PresentRegionKHR  present_region;
+	vk::PresentRegionsKHR present_regions;
+
+	if (m_use_incremental_present && !m_full_present)
+	{
+		const vk::Extent2D extent = m_swapchain.Extent();
+		const vk::Rect2D&  damage = m_ui_instance.Damage();
+
+		const uint32_t x0 = std::min(static_cast<uint32_t>(damage.offset.x), extent.width);
+		const uint32_t y0 = std::min(static_cast<uint32_t>(damage.offset.y), extent.height);
+		const uint32_t x1 = std::min(x0 + damage.extent.width, extent.width);
+		const uint32_t y1 = std::min(y0 + damage.extent.height, extent.height);
+
+		// No rects would mean the whole image changed, an unchanged frame reports a single pixel instead
+		present_rect = x1 > x0 && y1 > y0 ?
+			               vk::RectLayerKHR{{static_cast<int32_t>(x0), static_cast<int32_t>(y0)}, {x1 - x0, y1 - y0}, 0} :
+			               vk::RectLayerKHR{{0, 0}, {1, 1}, 0};
+
+		present_region     = {1, &present_rect};
+		present_regions    = {1, &present_region};
+		present_info.pNext = &present_regions;
+	}
+
 	const auto present_result = present_queue.presentKHR(&present_info);
 
 	if (present_result == vk::Result::eErrorOutOfDateKHR || present_result == vk::Result::eSuboptimalKHR || m_buffer_resized)
 	{
-		m_buffer_resized = false;
-		RecreateSwapchain();
+		m_buffer_resized   = false;
+		m_recreate_pending = true;
 	}
 	else if (present_result != vk::Result::eSuccess)
 	{
 		g_Logger.Error("Failed to present backbuffer");
 		return;
 	}
+	else
+	{
+		m_full_present = false;
+	}
 
 	m_current_frame = (m_current_frame + 1) % MAX_FRAMES_IN_FLIGHT;
 }
 
 void VkImguiDemo::CreateSyncObjects()
 {
-	m_inflight_fences.resize(MAX_FRAMES_IN_FLIGHT);
+	m_scheduler = VkRes::FrameScheduler(g_VkGenerator.Device(), MAX_FRAMES_IN_FLIGHT,
+	                                    g_VkGenerator.TimelineSemaphoreFeatures().timelineSemaphore);
+
+	// Acquire and present only take binary semaphores, so the swapchain keeps a pair per frame
 	m_image_available_semaphores.resize(MAX_FRAMES_IN_FLIGHT);
 	m_render_finished_semaphores.resize(MAX_FRAMES_IN_FLIGHT);
 
 	for (int i = 0 ; i < MAX_FRAMES_IN_FLIGHT ; i++)
 	{
-		m_inflight_fences[i]            = VkRes::Fence(g_VkGenerator.Device(), vk::FenceCreateFlagBits::eSignaled);
 		m_image_available_semaphores[i] = VkRes::Semaphore(g_VkGenerator.Device(), {});
 		m_render_finished_semaphores[i] = VkRes::Semaphore(g_VkGenerator.Device(), {});
 	}
@@ -203,11 +481,9 @@ void VkImguiDemo::CreateSyncObjects()
 
 void VkImguiDemo::RecordCmdBuffer()
 {
-	g_VkGenerator.Device().waitIdle();
-
 	vk::CommandBufferBeginInfo begin_info =
 	{
-		vk::CommandBufferUsageFlagBits::eSimultaneousUse,
+		vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
 		nullptr
 	};
 
@@ -216,38 +492,187 @@ void VkImguiDemo::RecordCmdBuffer()
 	clear_values[1].depthStencil.setDepth(1.0f);
 	clear_values[1].depthStencil.setStencil(0);
 
-	m_ui_instance.PrepNextFrame(m_frame_delta, m_total_time);
-	m_ui_instance.Update(g_VkGenerator.Device(), g_VkGenerator.PhysicalDevice());
-
-	for (auto buffer_index = 0 ; buffer_index < m_command.CommandBufferCount() ; ++buffer_index)
+	// Recorded by the record tasks already
+	if (!m_use_parallel_recording)
 	{
-		m_command.BeginRecording(&begin_info, buffer_index);
+		if (!m_scene_recorded[m_current_frame])
+		{
+			RecordSceneCmdBuffer(m_current_frame);
+		}
 
-		vk::RenderPassBeginInfo render_pass_begin_info =
+		if (m_ui_recorded_hashes[m_current_frame] != m_ui_instance.DrawDataHash())
 		{
-			m_render_pass.Pass(),
-			m_framebuffers[buffer_index].Buffer(),
-			vk::Rect2D{vk::Offset2D{0, 0}, m_swapchain.Extent()},
-			2,
-			clear_values.data()
-		};
+			RecordUICmdBuffer(m_current_frame);
+		}
+
+		m_secondary_buffers = {m_scene_command.CommandBuffer(m_current_frame), m_ui_command.CommandBuffer(m_current_frame)};
+	}
 
-		m_command.BeginRenderPass(&render_pass_begin_info, vk::SubpassContents::eInline, buffer_index);
+	// Allocated from the frame's transient pool, which AcquireNextImage already reset, so it starts out initial
+	m_primary = m_frame_pools.Allocate(g_VkGenerator.Device(), m_current_frame, 0);
 
-		m_command.SetViewport(0, m_swapchain.Extent().width, m_swapchain.Extent().height, 0.0f, 1.0f, buffer_index);
+	const auto begin_result = m_primary.begin(&begin_info);
+	assert(("Failed to begin recording a command buffer", begin_result == vk::Result::eSuccess));
 
-		m_command.SetScissor(0, m_swapchain.Extent().width, m_swapchain.Extent().height, buffer_index);
+	m_ui_instance.RecordUpload(m_primary);
+	m_ui_instance.RecordLayer(m_primary);
 
-		m_command.BindPipeline(vk::PipelineBindPoint::eGraphics, m_graphics_pipeline.Pipeline(), buffer_index);
+	vk::RenderPassBeginInfo render_pass_begin_info =
+	{
+		m_render_pass.Pass(),
+		m_framebuffers[m_image_index].Buffer(),
+		vk::Rect2D{vk::Offset2D{0, 0}, m_swapchain.Extent()},
+		2,
+		clear_values.data()
+	};
+
+	m_primary.beginRenderPass(&render_pass_begin_info, vk::SubpassContents::eSecondaryCommandBuffers);
+
+	if (m_ui_subpass == 0)
+	{
+		m_primary.executeCommands(static_cast<uint32_t>(m_secondary_buffers.size()), m_secondary_buffers.data());
+	}
+	else
+	{
+		m_primary.executeCommands(1, &m_secondary_buffers[0]);
+		m_primary.nextSubpass(vk::SubpassContents::eSecondaryCommandBuffers);
+		m_primary.executeCommands(static_cast<uint32_t>(m_secondary_buffers.size() - 1), &m_secondary_buffers[1]);
+	}
+
+	m_primary.endRenderPass();
+
+	m_primary.end();
+}
+
+void VkImguiDemo::RecordSceneCmdBuffer(int _frame)
+{
+	const vk::CommandBufferInheritanceInfo inheritance_info =
+	{
+		m_render_pass.Pass(),
+		0,
+		nullptr
+	};
+
+	vk::CommandBufferBeginInfo begin_info =
+	{
+		vk::CommandBufferUsageFlagBits::eRenderPassContinue | vk::CommandBufferUsageFlagBits::eSimultaneousUse,
+		&inheritance_info
+	};
+
+	m_scene_command.BeginRecording(&begin_info, _frame);
+
+	RecordScene(m_scene_command.CommandBuffer(_frame));
+
+	m_scene_command.EndRecording(_frame);
+
+	m_scene_recorded[_frame] = true;
+}
+
+void VkImguiDemo::RecordScene(vk::CommandBuffer _cmd_buffer)
+{
+	const vk::Viewport viewport =
+	{
+		0.0f,
+		0.0f,
+		static_cast<float>(m_swapchain.Extent().width),
+		static_cast<float>(m_swapchain.Extent().height),
+		0.0f,
+		1.0f
+	};
 
-		m_command.Draw(3, 1, 0, 0, buffer_index);
+	const vk::Rect2D scissor = {{0, 0}, m_swapchain.Extent()};
 
-		m_ui_instance.Draw(m_command, buffer_index);
+	_cmd_buffer.setViewport(0, 1, &viewport);
+	_cmd_buffer.setScissor(0, 1, &scissor);
+	_cmd_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, m_graphics_pipeline.Pipeline());
+	_cmd_buffer.draw(3, 1, 0, 0);
+}
+
+void VkImguiDemo::UpdateFrame()
+{
+	m_ui_instance.Update(g_VkGenerator.Device(), g_VkGenerator.PhysicalDevice(), m_current_frame);
 
-		m_command.EndRenderPass(buffer_index);
+	if (m_use_parallel_recording)
+	{
+		m_ui_chunks = m_ui_instance.DrawChunkCount(m_frame_pools.ThreadCount() - 1);
+		m_secondary_buffers.resize(m_ui_chunks + 1);
+	}
+}
 
-		m_command.EndRecording(buffer_index);
+void VkImguiDemo::RecordSecondaryCmdBuffer(uint32_t _task)
+{
+	if (m_frame_skipped || !m_use_parallel_recording || _task > m_ui_chunks)
+	{
+		return;
 	}
+
+	// Task 0 records the scene and the rest one UI chunk each. Every task allocates from the frame's pool with its
+	// own index, so no pool is used by two threads at once. Recorded for this frame only, the cached secondaries
+	// are left as they are
+	const vk::CommandBuffer cmd_buffer = m_frame_pools.Allocate(g_VkGenerator.Device(), m_current_frame, _task,
+	                                                            vk::CommandBufferLevel::eSecondary);
+
+	const vk::CommandBufferInheritanceInfo inheritance_info =
+	{
+		m_render_pass.Pass(),
+		_task == 0 ? 0 : m_ui_subpass,
+		m_framebuffers[m_image_index].Buffer()
+	};
+
+	vk::CommandBufferBeginInfo begin_info =
+	{
+		vk::CommandBufferUsageFlagBits::eRenderPassContinue | vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+		&inheritance_info
+	};
+
+	const auto result = cmd_buffer.begin(&begin_info);
+	assert(("Failed to begin recording a command buffer", result == vk::Result::eSuccess));
+
+	if (_task == 0)
+	{
+		RecordScene(cmd_buffer);
+	}
+	else
+	{
+		m_ui_instance.DrawChunk(cmd_buffer, _task - 1, m_ui_chunks);
+	}
+
+	cmd_buffer.end();
+
+	m_secondary_buffers[_task] = cmd_buffer;
+}
+
+void VkImguiDemo::RecordUICmdBuffer(int _frame)
+{
+	const vk::CommandBufferInheritanceInfo inheritance_info =
+	{
+		m_render_pass.Pass(),
+		m_ui_subpass,
+		nullptr
+	};
+
+	vk::CommandBufferBeginInfo begin_info =
+	{
+		vk::CommandBufferUsageFlagBits::eRenderPassContinue | vk::CommandBufferUsageFlagBits::eSimultaneousUse,
+		&inheritance_info
+	};
+
+	m_ui_command.BeginRecording(&begin_info, _frame);
+
+	m_ui_instance.Draw(m_ui_command, _frame);
+
+	m_ui_command.EndRecording(_frame);
+
+	m_ui_recorded_hashes[_frame] = m_ui_instance.DrawDataHash();
+}
+
+void VkImguiDemo::InvalidateSecondaryCmdBuffers()
+{
+	std::fill(m_scene_recorded.begin(), m_scene_recorded.end(), false);
+	std::fill(m_ui_recorded_hashes.begin(), m_ui_recorded_hashes.end(), 0);
+	m_ui_instance.InvalidateUploads();
+	m_redraw_needed = true;
+	m_full_present  = true;
 }
 
 void VkImguiDemo::CreateSwapchain()
@@ -259,11 +684,27 @@ void VkImguiDemo::CreateSwapchain()
 void VkImguiDemo::CreateCmdPool()
 {
 	m_command = VkRes::Command(g_VkGenerator.Device(), g_VkGenerator.QueueFamily());
+	m_jobs    = std::make_unique<JobSystem>(JobSystem::DefaultWorkerCount());
 }
 
 void VkImguiDemo::CreateCmdBuffers()
 {
-	m_command.CreateCmdBuffers(g_VkGenerator.Device(), m_swapchain.ImageViews().size());
+	// Primaries are re-recorded every frame, m_command only keeps its pool for single time commands.
+	// A pool per parallel recording task, the scene plus one UI chunk for each thread
+	m_frame_pools = VkRes::FrameCommandPools(g_VkGenerator.Device(), g_VkGenerator.QueueFamily(), MAX_FRAMES_IN_FLIGHT,
+	                                         m_jobs->WorkerCount() + 2);
+}
+
+void VkImguiDemo::CreateSecondaryCmdBuffers()
+{
+	m_scene_command = VkRes::Command(g_VkGenerator.Device(), g_VkGenerator.QueueFamily());
+	m_scene_command.CreateCmdBuffers(g_VkGenerator.Device(), MAX_FRAMES_IN_FLIGHT, vk::CommandBufferLevel::eSecondary);
+
+	m_ui_command = VkRes::Command(g_VkGenerator.Device(), g_VkGenerator.QueueFamily());
+	m_ui_command.CreateCmdBuffers(g_VkGenerator.Device(), MAX_FRAMES_IN_FLIGHT, vk::CommandBufferLevel::eSecondary);
+
+	m_ui_recorded_hashes.assign(MAX_FRAMES_IN_FLIGHT, 0);
+	m_scene_recorded.assign(MAX_FRAMES_IN_FLIGHT, false);
 }
 
 void VkImguiDemo::CreateRenderPasses()
@@ -285,18 +726,81 @@ void VkImguiDemo::CreateRenderPasses()
 		m_backbuffer.GetAttachmentDesc()
 	};
 
-	if (Settings::Instance()->use_msaa)
+	if (!m_msaa)
 	{
-		attachments.emplace_back(m_backbuffer.GetResolveAttachmentDesc());
+		m_render_pass = VkRes::RenderPass(attachments,
+		                                  &colour_attachment, 1,
+		                                  nullptr,
+		                                  nullptr, 1,
+		                                  vk::PipelineBindPoint::eGraphics, g_VkGenerator.Device());
+		m_ui_subpass = 0;
+		return;
 	}
 
-	m_render_pass = VkRes::RenderPass(attachments,
-	                                  &colour_attachment, 1,
-	                                  nullptr,
-	                                  Settings::Instance()->use_msaa ?
-		                                  &colour_resolve_attachment :
-		                                  nullptr, 1,
-	                                  vk::PipelineBindPoint::eGraphics, g_VkGenerator.Device());
+	// The scene renders and resolves at N samples, then the UI is drawn at 1x straight onto the resolved image.
+	// Nothing reads the multisampled image after the resolve, so it is never written out
+	attachments[0].setStoreOp(vk::AttachmentStoreOp::eDontCare);
+	attachments.emplace_back(m_backbuffer.GetResolveAttachmentDesc());
+
+	vk::AttachmentReference ui_colour_attachment =
+	{
+		1,
+		vk::ImageLayout::eColorAttachmentOptimal
+	};
+
+	const std::vector<vk::SubpassDescription> subpasses =
+	{
+		{
+			{},
+			vk::PipelineBindPoint::eGraphics,
+			0,
+			nullptr,
+			1,
+			&colour_attachment,
+			&colour_resolve_attachment,
+			nullptr,
+			0,
+			nullptr
+		},
+		{
+			{},
+			vk::PipelineBindPoint::eGraphics,
+			0,
+			nullptr,
+			1,
+			&ui_colour_attachment,
+			nullptr,
+			nullptr,
+			0,
+			nullptr
+		}
+	};
+
+	// The resolve is a colour attachment write at the end of the scene subpass, the UI blends over its result
+	const std::vector<vk::SubpassDependency> dependencies =
+	{
+		{
+			VK_SUBPASS_EXTERNAL,
+			0,
+			vk::PipelineStageFlagBits::eColorAttachmentOutput,
+			vk::PipelineStageFlagBits::eColorAttachmentOutput,
+			{},
+			vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite,
+			{}
+		},
+		{
+			0,
+			1,
+			vk::PipelineStageFlagBits::eColorAttachmentOutput,
+			vk::PipelineStageFlagBits::eColorAttachmentOutput,
+			vk::AccessFlagBits::eColorAttachmentWrite,
+			vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite,
+			vk::DependencyFlagBits::eByRegion
+		}
+	};
+
+	m_render_pass = VkRes::RenderPass(attachments, subpasses, dependencies, g_VkGenerator.Device());
+	m_ui_subpass  = 1;
 }
 
 void VkImguiDemo::CreateFrameBuffers()
@@ -308,7 +812,7 @@ void VkImguiDemo::CreateFrameBuffers()
 	{
 		std::vector<vk::ImageView> attachments;
 
-		if (Settings::Instance()->use_msaa && Settings::Instance()->GetSampleCount() > vk::SampleCountFlagBits::e1)
+		if (m_msaa && m_sample_count > vk::SampleCountFlagBits::e1)
 		{
 			attachments.push_back(m_backbuffer.GetImageView());
 		}
@@ -348,14 +852,9 @@ void VkImguiDemo::CreatePipelines()
 		m_frag.Set()
 	};
 
-	const bool                    msaa    = Settings::Instance()->use_msaa;
-	const vk::SampleCountFlagBits samples = msaa ?
-		                                        Settings::Instance()->GetSampleCount() :
-		                                        vk::SampleCountFlagBits::e1;
-
 	m_graphics_pipeline.SetInputAssembler(nullptr, {}, vk::PrimitiveTopology::eTriangleList, VK_FALSE);
 	m_graphics_pipeline.SetViewport(m_swapchain.Extent(), 0.0f, 1.0f);
-	m_graphics_pipeline.SetRasterizer(VK_TRUE, VK_TRUE, vk::CompareOp::eLess, samples, VK_FALSE);
+	m_graphics_pipeline.SetRasterizer(VK_TRUE, VK_TRUE, vk::CompareOp::eLess, m_sample_count, VK_FALSE);
 	m_graphics_pipeline.SetShaders(stages);
 	m_graphics_pipeline.CreatePipelineLayout(g_VkGenerator.Device(), nullptr, 0, 0);
 	m_graphics_pipeline.CreateGraphicPipeline(g_VkGenerator.Device(), m_render_pass.Pass());
@@ -363,20 +862,16 @@ void VkImguiDemo::CreatePipelines()
 
 void VkImguiDemo::CreateColourResources()
 {
-	const bool                    msaa    = Settings::Instance()->use_msaa;
-	const vk::SampleCountFlagBits samples = msaa ?
-		                                        Settings::Instance()->GetSampleCount() :
-		                                        vk::SampleCountFlagBits::e1;
-
 	m_backbuffer = VkRes::RenderTarget(g_VkGenerator.PhysicalDevice(), g_VkGenerator.Device(),
 	                                   m_swapchain.Extent().width, m_swapchain.Extent().height, m_swapchain.Format(),
-	                                   samples, vk::ImageTiling::eOptimal,
+	                                   m_sample_count, vk::ImageTiling::eOptimal,
 	                                   vk::ImageUsageFlagBits::eTransientAttachment | vk::ImageUsageFlagBits::eColorAttachment,
 	                                   vk::MemoryPropertyFlagBits::eDeviceLocal,
-	                                   (msaa) ?
+	                                   (m_msaa) ?
 		                                   vk::ImageLayout::eColorAttachmentOptimal :
 		                                   vk::ImageLayout::ePresentSrcKHR,
-	                                   m_command, g_VkGenerator.GraphicsQueue());
+	                                   m_command, g_VkGenerator.GraphicsQueue(),
+	                                   vk::ImageLayout::eUndefined); // the render pass starts from undefined
 }
 
 void VkImguiDemo::CreateDepthResources()
@@ -389,7 +884,7 @@ void VkImguiDemo::CleanSwapchain()
 	device.waitIdle();
 
 	m_backbuffer.Destroy(device);
-	m_command.FreeCommandBuffers(device);
+	m_frame_pools.Destroy(device);
 	m_graphics_pipeline.Destroy(device);
 	m_render_pass.Destroy(device);
 	for (auto& i : m_framebuffers)
@@ -399,15 +894,17 @@ void VkImguiDemo::CleanSwapchain()
 	m_swapchain.Destroy(device);
 }
 
-void VkImguiDemo::RecreateSwapchain()
+void VkImguiDemo::CaptureRenderSettings()
 {
-	int width = 0, height = 0;
-	while (width == 0 || height == 0)
-	{
-		glfwGetFramebufferSize(g_VkGenerator.WindowHdle(), &width, &height);
-		glfwWaitEvents();
-	}
+	m_msaa         = Settings::Instance()->use_msaa;
+	m_sample_count = m_msaa ?
+		                 Settings::Instance()->GetSampleCount() :
+		                 vk::SampleCountFlagBits::e1;
+}
 
+void VkImguiDemo::RecreateSwapchain()
+{
+	// Only called with a usable window size, RenderLoop waits out a minimised window
 	g_VkGenerator.Device().waitIdle();
 	g_VkGenerator.RefreshSwapchainDetails();
 
@@ -419,4 +916,44 @@ void VkImguiDemo::RecreateSwapchain()
 	CreateRenderPasses();
 	CreateFrameBuffers();
 	CreatePipelines();
+
+	// Render pass and pipelines were rebuilt, the cached secondaries reference the old ones
+	InvalidateSecondaryCmdBuffers();
+}
+
+void VkImguiDemo::ResizeSwapchain()
+{
+	const auto device = g_VkGenerator.Device();
+
+	// Frames in flight still draw into the old images, so the old swapchain, its framebuffers and the colour target
+	// are retired together once the next submit has finished rather than after a device wait
+	VkRes::Swapchain                old_swapchain    = m_swapchain;
+	std::vector<VkRes::FrameBuffer> old_framebuffers = std::move(m_framebuffers);
+	VkRes::RenderTarget             old_backbuffer   = m_backbuffer;
+
+	m_scheduler.Defer([device, old_swapchain, old_framebuffers, old_backbuffer]() mutable
+	{
+		for (auto& framebuffer : old_framebuffers)
+		{
+			framebuffer.Destroy(device);
+		}
+
+		old_backbuffer.Destroy(device);
+		old_swapchain.Destroy(device);
+	});
+
+	m_swapchain = VkRes::Swapchain(g_VkGenerator.PhysicalDevice(), device, g_VkGenerator.Surface(),
+	                               g_VkGenerator.SwapchainDetails(), g_VkGenerator.QueueFamily(),
+	                               old_swapchain.SwapchainInstance());
+
+	// The render pass and pipelines only depend on the format, which RenderLoop checked. Viewport and scissor are
+	// dynamic state
+	CreateColourResources();
+	CreateFrameBuffers();
+
+	// The scene's secondaries record the old extent, each slot re-records once its last frame retired.
+	// The UI's inherit no framebuffer and draw at the UI's own size, so they stay valid
+	std::fill(m_scene_recorded.begin(), m_scene_recorded.end(), false);
+	m_redraw_needed = true;
+	m_full_present  = true;
 }
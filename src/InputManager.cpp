@@ -13,6 +13,10 @@ static GLFWmousebuttonfun g_PrevUserCallbackMousebutton = nullptr;
 static GLFWscrollfun      g_PrevUserCallbackScroll = nullptr;
 static GLFWkeyfun         g_PrevUserCallbackKey = nullptr;
 static GLFWcharfun        g_PrevUserCallbackChar = nullptr;
+static GLFWcursorposfun   g_PrevUserCallbackCursorPos = nullptr;
+
+// Set by every input callback, lets the idle mode tell a quiet frame from a busy one
+static bool g_InputReceived = false;
 
 void ImGui_ImplGlfw_MouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
 {
@@ -21,6 +25,8 @@ void ImGui_ImplGlfw_MouseButtonCallback(GLFWwindow* window, int button, int acti
 
 	if (action == GLFW_PRESS && button >= 0 && button < IM_ARRAYSIZE(g_MouseJustPressed))
 		g_MouseJustPressed[button] = true;
+
+	g_InputReceived = true;
 }
 
 void ImGui_ImplGlfw_ScrollCallback(GLFWwindow* window, double xoffset, double yoffset)
@@ -31,6 +37,8 @@ void ImGui_ImplGlfw_ScrollCallback(GLFWwindow* window, double xoffset, double yo
 	ImGuiIO& io = ImGui::GetIO();
 	io.MouseWheelH += (float)xoffset;
 	io.MouseWheel += (float)yoffset;
+
+	g_InputReceived = true;
 }
 
 void ImGui_ImplGlfw_KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
@@ -50,6 +58,8 @@ void ImGui_ImplGlfw_KeyCallback(GLFWwindow* window, int key, int scancode, int a
 	io.KeyAlt = io.KeysDown[GLFW_KEY_LEFT_ALT] || io.KeysDown[GLFW_KEY_RIGHT_ALT];
 	io.KeySuper = io.KeysDown[GLFW_KEY_LEFT_SUPER] || io.KeysDown[GLFW_KEY_RIGHT_SUPER];
 
+	g_InputReceived = true;
+
 	if (action != 0)
 	{
 		if (g_AllKeyStates[key] == EKeyState::NotPressed)
@@ -74,6 +84,17 @@ void ImGui_ImplGlfw_CharCallback(GLFWwindow* window, unsigned int c)
 
 	ImGuiIO& io = ImGui::GetIO();
 	io.AddInputCharacter(c);
+
+	g_InputReceived = true;
+}
+
+void ImGui_ImplGlfw_CursorPosCallback(GLFWwindow* window, double x, double y)
+{
+	if (g_PrevUserCallbackCursorPos != NULL)
+		g_PrevUserCallbackCursorPos(window, x, y);
+
+	// The position itself is polled in UpdateMousePosAndButtons
+	g_InputReceived = true;
 }
 
 static void ImGui_ImplGlfw_UpdateMousePosAndButtons()
@@ -156,6 +177,7 @@ void InputManager::InitialiseInput(GLFWwindow* _window)
 	g_PrevUserCallbackScroll      = glfwSetScrollCallback(_window, ImGui_ImplGlfw_ScrollCallback);
 	g_PrevUserCallbackKey         = glfwSetKeyCallback(_window, ImGui_ImplGlfw_KeyCallback);
 	g_PrevUserCallbackChar        = glfwSetCharCallback(_window, ImGui_ImplGlfw_CharCallback);
+	g_PrevUserCallbackCursorPos   = glfwSetCursorPosCallback(_window, ImGui_ImplGlfw_CursorPosCallback);
 }
 
 bool InputManager::KeyHeld(EKeyCodes _key_code)
@@ -180,6 +202,13 @@ bool InputManager::KeyHit(EKeyCodes _key_code)
 	return false;
 }
 
+bool InputManager::ConsumeInputReceived()
+{
+	const bool received = g_InputReceived;
+	g_InputReceived     = false;
+	return received;
+}
+
 EKeyState InputManager::ReportKeyState(EKeyCodes _key_code)
 {
 	return g_AllKeyStates[static_cast<int>(_key_code)];
@@ -0,0 +1,267 @@
+#include "include/JobSystem.h"
+
+#include <algorithm>
+#include <cassert>
+
+JobSystem::JobSystem(uint32_t _worker_count)
+{
+	for (uint32_t i = 0 ; i <= _worker_count ; ++i)
+	{
+		m_queues.push_back(std::make_unique<Queue>());
+	}
+
+	m_workers.reserve(_worker_count);
+	for (uint32_t i = 0 ; i < _worker_count ; ++i)
+	{
+		m_workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_sleep_mutex);
+		m_stop = true;
+	}
+
+	m_wake.notify_all();
+
+	for (auto& worker : m_workers)
+	{
+		worker.join();
+	}
+}
+
+uint32_t JobSystem::DefaultWorkerCount(uint32_t _max)
+{
+	const uint32_t cores = std::thread::hardware_concurrency();
+	return std::min(cores > 1 ? cores - 1 : 0, _max);
+}
+
+JobSystem::TaskId JobSystem::Add(const char* _name, std::function<void()> _func)
+{
+	assert(("Tasks can only be added while no graph is running", !Running()));
+
+	auto task         = std::make_unique<Task>();
+	task->func        = std::move(_func);
+	task->timing.name = _name;
+
+	m_tasks.push_back(std::move(task));
+	return static_cast<TaskId>(m_tasks.size() - 1);
+}
+
+void JobSystem::Depend(TaskId _task, TaskId _dependency)
+{
+	assert(("Dependencies can only be added while no graph is running", !Running()));
+
+	m_tasks[_dependency]->dependents.push_back(_task);
+	m_tasks[_task]->pending.fetch_add(1, std::memory_order_relaxed);
+}
+
+void JobSystem::Launch()
+{
+	if (m_tasks.empty())
+	{
+		return;
+	}
+
+	m_launched    = true;
+	m_launch_time = Clock::now();
+	m_remaining.store(static_cast<uint32_t>(m_tasks.size()), std::memory_order_release);
+
+	// Collected first, a root can finish and unblock others before the loop reaches them
+	m_roots.clear();
+	for (TaskId id = 0 ; id < m_tasks.size() ; ++id)
+	{
+		if (m_tasks[id]->pending.load(std::memory_order_relaxed) == 0)
+		{
+			m_roots.push_back(id);
+		}
+	}
+
+	for (const TaskId id : m_roots)
+	{
+		Push(WorkerCount(), id);
+	}
+}
+
+void JobSystem::Wait(TaskId _task)
+{
+	const uint32_t owner = WorkerCount();
+
+	while (!m_tasks[_task]->done.load(std::memory_order_acquire))
+	{
+		if (RunOne(owner))
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_sleep_mutex);
+		m_wake.wait(lock, [&]
+		{
+			return m_tasks[_task]->done.load(std::memory_order_acquire) || m_queued.load(std::memory_order_acquire) != 0;
+		});
+	}
+}
+
+void JobSystem::WaitAll()
+{
+	const uint32_t owner = WorkerCount();
+
+	while (Running())
+	{
+		if (RunOne(owner))
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_sleep_mutex);
+		m_wake.wait(lock, [&]
+		{
+			return !Running() || m_queued.load(std::memory_order_acquire) != 0;
+		});
+	}
+
+	if (!m_launched)
+	{
+		return;
+	}
+
+	m_launched = false;
+
+	m_timings.clear();
+	for (const auto& task : m_tasks)
+	{
+		m_timings.push_back(task->timing);
+	}
+	std::sort(m_timings.begin(), m_timings.end(), [](const Timing& _a, const Timing& _b)
+	{
+		return _a.begin < _b.begin;
+	});
+
+	m_tasks.clear();
+}
+
+void JobSystem::WorkerLoop(uint32_t _index)
+{
+	for (;;)
+	{
+		if (RunOne(_index))
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_sleep_mutex);
+		m_wake.wait(lock, [this]
+		{
+			return m_stop || m_queued.load(std::memory_order_acquire) != 0;
+		});
+
+		if (m_stop)
+		{
+			return;
+		}
+	}
+}
+
+void JobSystem::Push(uint32_t _queue, TaskId _task)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_queues[_queue]->mutex);
+		m_queues[_queue]->tasks.push_back(_task);
+	}
+
+	m_queued.fetch_add(1, std::memory_order_release);
+
+	// Taking the lock orders the wake up after a sleeper's predicate check
+	{
+		std::lock_guard<std::mutex> lock(m_sleep_mutex);
+	}
+	m_wake.notify_all();
+}
+
+bool JobSystem::Pop(uint32_t _queue, TaskId& _task)
+{
+	Queue&                      queue = *m_queues[_queue];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+
+	if (queue.tasks.empty())
+	{
+		return false;
+	}
+
+	_task = queue.tasks.back();
+	queue.tasks.pop_back();
+	return true;
+}
+
+bool JobSystem::Steal(uint32_t _thief, TaskId& _task)
+{
+	const auto queue_count = static_cast<uint32_t>(m_queues.size());
+
+	// Starting after the thief spreads the thieves across the victims
+	for (uint32_t offset = 1 ; offset < queue_count ; ++offset)
+	{
+		Queue&                      queue = *m_queues[(_thief + offset) % queue_count];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		if (!queue.tasks.empty())
+		{
+			_task = queue.tasks.front();
+			queue.tasks.pop_front();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool JobSystem::RunOne(uint32_t _thread)
+{
+	TaskId task;
+	if (!Pop(_thread, task) && !Steal(_thread, task))
+	{
+		return false;
+	}
+
+	m_queued.fetch_sub(1, std::memory_order_acq_rel);
+	Execute(_thread, task);
+	return true;
+}
+
+void JobSystem::Execute(uint32_t _thread, TaskId _task)
+{
+	Task& task = *m_tasks[_task];
+
+	task.timing.thread = _thread;
+	task.timing.begin  = Elapsed();
+	task.func();
+	task.timing.end = Elapsed();
+
+	// Marked before the dependents are queued, so a thread waiting for this task does not pick them up first
+	task.done.store(true, std::memory_order_release);
+
+	for (const TaskId dependent : task.dependents)
+	{
+		if (m_tasks[dependent]->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			Push(_thread, dependent);
+		}
+	}
+
+	// Last touch of the graph, once it reaches zero the owner may clear the tasks
+	const bool last = m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1;
+
+	if (last || _thread != WorkerCount())
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_sleep_mutex);
+		}
+		m_wake.notify_all();
+	}
+}
+
+double JobSystem::Elapsed() const
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - m_launch_time).count();
+}
@@ -3,7 +3,7 @@
 VkGen::VkGenerator g_VkGenerator(1280, 720);
 Logger             g_Logger;
 
-int main()
+int main(int argc, char** argv)
 {
 #ifdef _DEBUG
 	const HANDLE cmd_handle = GetStdHandle(STD_OUTPUT_HANDLE);
@@ -20,6 +20,8 @@ int main()
 
 	VkImguiDemo imgui_demo;
 	imgui_demo.SetShaderDirectory("../shaders/");
+	// First argument overrides the font used for glyphs outside the baked ranges
+	imgui_demo.SetFontFile(argc > 1 ? argv[1] : "C:/Windows/Fonts/msyh.ttc", 16.0f);
 	imgui_demo.Setup();
 	imgui_demo.Run();
 	imgui_demo.Shutdown();
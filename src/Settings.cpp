@@ -33,6 +33,114 @@ void Settings::SetMSAA(const bool _value)
 	}
 }
 
+void Settings::SetIndirectDraw(const bool _value)
+{
+	const bool tmp   = ui_indirect_draw;
+	ui_indirect_draw = _value;
+
+	if (tmp != ui_indirect_draw)
+	{
+		m_updated = true;
+	}
+}
+
+void Settings::SetPackedVertices(const bool _value)
+{
+	const bool tmp     = ui_packed_vertices;
+	ui_packed_vertices = _value;
+
+	if (tmp != ui_packed_vertices)
+	{
+		m_updated = true;
+	}
+}
+
+void Settings::SetParallelUpload(const bool _value)
+{
+	ui_parallel_upload = _value;
+}
+
+void Settings::SetStagedUpload(const bool _value)
+{
+	const bool tmp   = ui_staged_upload;
+	ui_staged_upload = _value;
+
+	if (tmp != ui_staged_upload)
+	{
+		m_updated = true;
+	}
+}
+
+void Settings::SetBindlessTextures(const bool _value)
+{
+	const bool tmp       = ui_bindless_textures;
+	ui_bindless_textures = _value;
+
+	if (tmp != ui_bindless_textures)
+	{
+		m_updated = true;
+	}
+}
+
+void Settings::SetDynamicGlyphs(const bool _value)
+{
+	const bool tmp    = ui_dynamic_glyphs;
+	ui_dynamic_glyphs = _value;
+
+	if (tmp != ui_dynamic_glyphs)
+	{
+		m_updated = true;
+	}
+}
+
+void Settings::SetAlphaAtlas(const bool _value)
+{
+	const bool tmp = ui_alpha_atlas;
+	ui_alpha_atlas = _value;
+
+	if (tmp != ui_alpha_atlas)
+	{
+		m_updated = true;
+	}
+}
+
+void Settings::SetSdfText(const bool _value)
+{
+	const bool tmp = ui_sdf_text;
+	ui_sdf_text    = _value;
+
+	if (tmp != ui_sdf_text)
+	{
+		m_updated = true;
+	}
+}
+
+void Settings::SetCachedLayer(const bool _value)
+{
+	const bool tmp  = ui_cached_layer;
+	ui_cached_layer = _value;
+
+	if (tmp != ui_cached_layer)
+	{
+		m_updated = true;
+	}
+}
+
+void Settings::SetIdleMode(const bool _value)
+{
+	idle_mode = _value;
+}
+
+void Settings::SetIncrementalPresent(const bool _value)
+{
+	incremental_present = _value;
+}
+
+void Settings::SetParallelRecording(const bool _value)
+{
+	parallel_recording = _value;
+}
+
 // https://graphics.stanford.edu/~seander/bithacks.html#RoundUpPowerOf2
 unsigned long SampleCount(unsigned long v)
 {
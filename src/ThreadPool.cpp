@@ -0,0 +1,111 @@
+#include "include\ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(uint32_t _worker_count)
+{
+	m_workers.reserve(_worker_count);
+	for (uint32_t i = 0 ; i < _worker_count ; ++i)
+	{
+		m_workers.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+
+	m_wake.notify_all();
+
+	for (auto& worker : m_workers)
+	{
+		worker.join();
+	}
+}
+
+uint32_t ThreadPool::DefaultWorkerCount(uint32_t _max)
+{
+	const uint32_t cores = std::thread::hardware_concurrency();
+	return std::min(cores > 1 ? cores - 1 : 0, _max);
+}
+
+void ThreadPool::ParallelFor(uint32_t _count, const std::function<void(uint32_t)>& _func)
+{
+	if (_count == 0)
+	{
+		return;
+	}
+
+	if (m_workers.empty() || _count == 1)
+	{
+		for (uint32_t i = 0 ; i < _count ; ++i)
+		{
+			_func(i);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_func   = &_func;
+		m_count  = _count;
+		m_active = static_cast<uint32_t>(m_workers.size());
+		m_next.store(0, std::memory_order_relaxed);
+		++m_generation;
+	}
+
+	m_wake.notify_all();
+
+	RunItems();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_done.wait(lock, [this]
+	{
+		return m_active == 0;
+	});
+	m_func = nullptr;
+}
+
+void ThreadPool::WorkerLoop()
+{
+	uint64_t seen_generation = 0;
+
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wake.wait(lock, [&]
+			{
+				return m_stop || m_generation != seen_generation;
+			});
+
+			if (m_stop)
+			{
+				return;
+			}
+
+			seen_generation = m_generation;
+		}
+
+		RunItems();
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (--m_active == 0)
+		{
+			m_done.notify_one();
+		}
+	}
+}
+
+void ThreadPool::RunItems()
+{
+	for (uint32_t i = m_next.fetch_add(1, std::memory_order_relaxed) ;
+	     i < m_count ;
+	     i = m_next.fetch_add(1, std::memory_order_relaxed))
+	{
+		(*m_func)(i);
+	}
+}
@@ -1,7 +1,186 @@
 #include "include\UI.h"
+#include "include\Hash.h"
+#include "include\UIVertex.h"
 #include "include\imgui-1.70\imgui.h"
 #include "include/glfw-3.2.1.bin.WIN32/include/GLFW/glfw3.h"
 
+#include <chrono>
+#include <cmath>
+
+extern VkGen::VkGenerator g_VkGenerator;
+
+// ImDrawIdx is 16 bit unless imconfig.h (or the project's preprocessor definitions) sets
+// ImDrawIdx to unsigned int, the renderer follows whichever width ImGui was built with
+static_assert(sizeof(ImDrawIdx) == 2 || sizeof(ImDrawIdx) == 4, "ImDrawIdx must be 16 or 32 bit");
+
+constexpr vk::IndexType k_index_type = sizeof(ImDrawIdx) == 2 ?
+	                                       vk::IndexType::eUint16 :
+	                                       vk::IndexType::eUint32;
+
+// Texture slots available to ImTextureIDs, ui_bindless.frag and ui_indirect_bindless.frag declare the same array size
+constexpr uint32_t k_ui_texture_capacity = 1024;
+
+// Per draw entry read by ui_indirect.vert, std430 layout
+struct IndirectDrawData
+{
+	ImVec4   clip_rect;
+	uint32_t texture[4];
+};
+
+static ImTextureID ToTextureID(uint32_t _slot)
+{
+	return reinterpret_cast<ImTextureID>(static_cast<intptr_t>(_slot));
+}
+
+// Below this much source geometry the upload stays on the calling thread
+constexpr vk::DeviceSize k_parallel_upload_threshold = 256 * 1024;
+
+// Fewest batches worth a secondary of their own when recording in parallel
+constexpr uint32_t k_record_chunk_batches = 128;
+
+// Before 1.71 ImGui has no per command offsets, every command continues where the previous one ended
+#if IMGUI_VERSION_NUM >= 17100
+#define UI_HAS_VTX_OFFSET 1
+#endif
+
+static uint64_t HashDrawList(const ImDrawList* _cmd_list)
+{
+	uint64_t hash = Hash::Bytes(_cmd_list->VtxBuffer.Data, _cmd_list->VtxBuffer.Size * sizeof(ImDrawVert));
+	hash          = Hash::Bytes(_cmd_list->IdxBuffer.Data, _cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx), hash);
+
+	// ImDrawCmd has padding, so hash the fields rather than the raw struct
+	for (const ImDrawCmd& cmd : _cmd_list->CmdBuffer)
+	{
+		hash = Hash::Combine(hash, Hash::Value(cmd.ElemCount));
+		hash = Hash::Combine(hash, Hash::Value(cmd.ClipRect));
+		hash = Hash::Combine(hash, Hash::Value(cmd.TextureId));
+		hash = Hash::Combine(hash, Hash::Value(cmd.UserCallback));
+#ifdef UI_HAS_VTX_OFFSET
+		hash = Hash::Combine(hash, Hash::Value(cmd.VtxOffset));
+		hash = Hash::Combine(hash, Hash::Value(cmd.IdxOffset));
+#endif
+	}
+
+	return hash;
+}
+
+static bool Contains(const vk::Rect2D& _outer, const vk::Rect2D& _inner)
+{
+	return _inner.offset.x >= _outer.offset.x && _inner.offset.y >= _outer.offset.y &&
+		_inner.offset.x + _inner.extent.width <= _outer.offset.x + _outer.extent.width &&
+		_inner.offset.y + _inner.extent.height <= _outer.offset.y + _outer.extent.height;
+}
+
+// True if every vertex referenced by the index range already lies inside the rect, in which case
+// drawing it with a larger scissor produces exactly the same pixels
+static bool GeometryInside(const ImDrawList* _cmd_list,
+                           uint32_t          _first_index,
+                           uint32_t          _count,
+                           uint32_t          _vtx_offset,
+                           const vk::Rect2D& _rect)
+{
+	const float x0 = static_cast<float>(_rect.offset.x);
+	const float y0 = static_cast<float>(_rect.offset.y);
+	const float x1 = x0 + static_cast<float>(_rect.extent.width);
+	const float y1 = y0 + static_cast<float>(_rect.extent.height);
+
+	for (uint32_t i = _first_index ; i < _first_index + _count ; ++i)
+	{
+		const ImVec2& pos = _cmd_list->VtxBuffer[_vtx_offset + _cmd_list->IdxBuffer[i]].pos;
+		if (pos.x < x0 || pos.y < y0 || pos.x > x1 || pos.y > y1)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool Empty(const vk::Rect2D& _rect)
+{
+	return _rect.extent.width == 0 || _rect.extent.height == 0;
+}
+
+static vk::Rect2D Union(const vk::Rect2D& _a, const vk::Rect2D& _b)
+{
+	if (Empty(_a))
+	{
+		return _b;
+	}
+
+	if (Empty(_b))
+	{
+		return _a;
+	}
+
+	const int32_t x0 = std::min(_a.offset.x, _b.offset.x);
+	const int32_t y0 = std::min(_a.offset.y, _b.offset.y);
+	const int32_t x1 = std::max(_a.offset.x + static_cast<int32_t>(_a.extent.width), _b.offset.x + static_cast<int32_t>(_b.extent.width));
+	const int32_t y1 = std::max(_a.offset.y + static_cast<int32_t>(_a.extent.height), _b.offset.y + static_cast<int32_t>(_b.extent.height));
+
+	return {{x0, y0}, {static_cast<uint32_t>(x1 - x0), static_cast<uint32_t>(y1 - y0)}};
+}
+
+static vk::Rect2D Intersect(const vk::Rect2D& _a, const vk::Rect2D& _b)
+{
+	const int32_t x0 = std::max(_a.offset.x, _b.offset.x);
+	const int32_t y0 = std::max(_a.offset.y, _b.offset.y);
+	const int32_t x1 = std::min(_a.offset.x + static_cast<int32_t>(_a.extent.width), _b.offset.x + static_cast<int32_t>(_b.extent.width));
+	const int32_t y1 = std::min(_a.offset.y + static_cast<int32_t>(_a.extent.height), _b.offset.y + static_cast<int32_t>(_b.extent.height));
+
+	if (x1 <= x0 || y1 <= y0)
+	{
+		return {};
+	}
+
+	return {{x0, y0}, {static_cast<uint32_t>(x1 - x0), static_cast<uint32_t>(y1 - y0)}};
+}
+
+// Every pixel a list touches lies inside one of its clip rects
+static vk::Rect2D ListBounds(const ImDrawList* _cmd_list, const vk::Rect2D& _framebuffer)
+{
+	vk::Rect2D bounds = {};
+
+	for (const ImDrawCmd& cmd : _cmd_list->CmdBuffer)
+	{
+		if (cmd.ElemCount == 0)
+		{
+			continue;
+		}
+
+		const int32_t x0 = static_cast<int32_t>(std::floor(cmd.ClipRect.x));
+		const int32_t y0 = static_cast<int32_t>(std::floor(cmd.ClipRect.y));
+		const int32_t x1 = static_cast<int32_t>(std::ceil(cmd.ClipRect.z));
+		const int32_t y1 = static_cast<int32_t>(std::ceil(cmd.ClipRect.w));
+
+		if (x1 <= x0 || y1 <= y0)
+		{
+			continue;
+		}
+
+		const vk::Rect2D clip = {{x0, y0}, {static_cast<uint32_t>(x1 - x0), static_cast<uint32_t>(y1 - y0)}};
+		bounds                = Union(bounds, Intersect(clip, _framebuffer));
+	}
+
+	return bounds;
+}
+
+static void AppendRange(std::vector<VkRes::RingBuffer::Range>& _ranges, vk::DeviceSize _offset, vk::DeviceSize _size)
+{
+	if (_size == 0)
+	{
+		return;
+	}
+
+	if (!_ranges.empty() && _ranges.back().offset + _ranges.back().size == _offset)
+	{
+		_ranges.back().size += _size;
+		return;
+	}
+
+	_ranges.push_back({_offset, _size});
+}
+
 
 void UI::Destroy(vk::Device _device)
 {
@@ -13,12 +192,27 @@ void UI::Destroy(vk::Device _device)
 
 	m_vertex_buffer.Destroy(_device);
 	m_index_buffer.Destroy(_device);
+	m_device_vertex_buffer.Destroy(_device);
+	m_device_index_buffer.Destroy(_device);
+	m_indirect_buffer.Destroy(_device);
+	m_draw_data_buffer.Destroy(_device);
+	m_glyph_buffer.Destroy(_device);
+	m_glyph_copies.clear();
 
 	m_vert.Destroy(_device);
 	m_frag.Destroy(_device);
 
 	m_pipeline.Destroy(_device);
 
+	m_composite_vert.Destroy(_device);
+	m_composite_frag.Destroy(_device);
+	m_composite_pipeline.Destroy(_device);
+	m_layer_framebuffer.Destroy(_device);
+	m_layer_pass.Destroy(_device);
+	m_layer.Destroy(_device);
+	m_damage_lists.clear();
+	m_full_damage = true;
+
 	if (m_desc_pool != nullptr)
 	{
 		_device.destroyDescriptorPool(m_desc_pool);
@@ -30,6 +224,32 @@ void UI::Destroy(vk::Device _device)
 		_device.destroyDescriptorSetLayout(m_desc_set_layout);
 		m_desc_set_layout = nullptr;
 	}
+
+	if (m_draw_set_layout != nullptr)
+	{
+		_device.destroyDescriptorSetLayout(m_draw_set_layout);
+		m_draw_set_layout = nullptr;
+	}
+
+	if (m_layer_set_layout != nullptr)
+	{
+		_device.destroyDescriptorSetLayout(m_layer_set_layout);
+		m_layer_set_layout = nullptr;
+	}
+
+	m_draw_sets.clear();
+
+	// Registrations outlive the pool, their descriptors are written again by the next LoadResources
+	for (auto& texture : m_textures)
+	{
+		texture.set = nullptr;
+	}
+
+	if (m_atlas_preview != nullptr)
+	{
+		UnregisterTexture(m_atlas_preview);
+		m_atlas_preview = nullptr;
+	}
 }
 
 void UI::Recreate(vk::Device _device, uint32_t _width, uint32_t _height, GLFWwindow* _window)
@@ -42,6 +262,9 @@ void UI::Recreate(vk::Device _device, uint32_t _width, uint32_t _height, GLFWwin
 	ImGuiIO& io = ImGui::GetIO();
 	io.BackendFlags |= ImGuiBackendFlags_HasMouseCursors;
 	io.BackendFlags |= ImGuiBackendFlags_HasSetMousePos;
+#ifdef UI_HAS_VTX_OFFSET
+	io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+#endif
 	io.ClipboardUserData       = _window;
 	io.DisplaySize             = ImVec2(m_width, m_height);
 	io.DisplayFramebufferScale = ImVec2(1.0f, 1.0f);
@@ -52,9 +275,6 @@ void UI::Recreate(vk::Device _device, uint32_t _width, uint32_t _height, GLFWwin
 	io.WantTextInput           = true;
 	io.WantSaveIniSettings     = false;
 	io.IniFilename             = "imgui.ini";
-
-	m_vertex_buffer.Destroy(_device);
-	m_index_buffer.Destroy(_device);
 }
 
 void UI::Init(uint32_t _width, uint32_t _height, GLFWwindow* _window)
@@ -74,6 +294,9 @@ void UI::Init(uint32_t _width, uint32_t _height, GLFWwindow* _window)
 	ImGuiIO& io = ImGui::GetIO();
 	io.BackendFlags |= ImGuiBackendFlags_HasMouseCursors;
 	io.BackendFlags |= ImGuiBackendFlags_HasSetMousePos;
+#ifdef UI_HAS_VTX_OFFSET
+	io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+#endif
 	io.ClipboardUserData       = _window;
 	io.DisplaySize             = ImVec2(m_width, m_height);
 	io.DisplayFramebufferScale = ImVec2(1.0f, 1.0f);
@@ -114,26 +337,132 @@ void UI::LoadResources(vk::Device              _device,
                        VkRes::Command          _cmd,
                        vk::RenderPass          _pass,
                        vk::Queue               _queue,
-                       vk::SampleCountFlagBits _samples)
+                       vk::SampleCountFlagBits _samples,
+                       uint32_t                _frames_in_flight,
+                       uint32_t                _subpass)
 {
 	ImGuiIO& io = ImGui::GetIO();
 
-	m_font_tex = VkRes::Texture<VkRes::ETextureLoader::Imgui>(_device, _physical_device, _cmd, _queue);
+	const vk::PhysicalDeviceProperties properties = _physical_device.getProperties();
+	const vk::PhysicalDeviceFeatures&  features   = g_VkGenerator.EnabledFeatures();
+	const vk::DeviceSize               atom_size  = properties.limits.nonCoherentAtomSize;
+
+	// Each indirect draw finds its clip rect through firstInstance, without that feature stay on the direct path
+	m_indirect_draw           = Settings::Instance()->ui_indirect_draw && features.drawIndirectFirstInstance;
+	m_packed_vertices         = Settings::Instance()->ui_packed_vertices;
+	m_vertex_stride           = m_packed_vertices ?
+		                            sizeof(UIPackedVertex) :
+		                            sizeof(ImDrawVert);
+	m_multi_draw_indirect     = features.multiDrawIndirect;
+	m_max_draw_indirect_count = m_multi_draw_indirect ?
+		                            properties.limits.maxDrawIndirectCount :
+		                            1;
+
+	m_staged_upload = Settings::Instance()->ui_staged_upload;
+	m_cached_layer  = Settings::Instance()->ui_cached_layer;
+
+	// Staged mode turns the mapped rings into staging memory and draws from device local copies
+	const vk::BufferUsageFlags staging_usage = m_staged_upload ?
+		                                           vk::BufferUsageFlagBits::eTransferSrc :
+		                                           vk::BufferUsageFlags{};
+
+	m_vertex_buffer    = VkRes::RingBuffer(_frames_in_flight, vk::BufferUsageFlagBits::eVertexBuffer | staging_usage, atom_size);
+	m_index_buffer     = VkRes::RingBuffer(_frames_in_flight, vk::BufferUsageFlagBits::eIndexBuffer | staging_usage, atom_size);
+	m_indirect_buffer  = VkRes::RingBuffer(_frames_in_flight, vk::BufferUsageFlagBits::eIndirectBuffer, atom_size, 4 * 1024);
+	m_draw_data_buffer = VkRes::RingBuffer(_frames_in_flight, vk::BufferUsageFlagBits::eStorageBuffer, atom_size, 4 * 1024);
+	m_upload_records.assign(_frames_in_flight, {});
+
+	if (m_staged_upload)
+	{
+		m_device_vertex_buffer = VkRes::RingBuffer(_frames_in_flight,
+		                                           vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst,
+		                                           atom_size,
+		                                           64 * 1024,
+		                                           vk::MemoryPropertyFlagBits::eDeviceLocal);
+		m_device_index_buffer  = VkRes::RingBuffer(_frames_in_flight,
+		                                           vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst,
+		                                           atom_size,
+		                                           64 * 1024,
+		                                           vk::MemoryPropertyFlagBits::eDeviceLocal);
+	}
+
+	// Only the default ranges are baked, the glyph cache reserves a region of the atlas for everything else.
+	// Distance field text is produced by the cache, so it needs the font file as well
+	m_sdf_text       = Settings::Instance()->ui_sdf_text && m_glyph_cache.Loaded();
+	m_dynamic_glyphs = (Settings::Instance()->ui_dynamic_glyphs || m_sdf_text) && m_glyph_cache.Loaded();
+
+	// Alpha8 stores only glyph coverage, a quarter of the RGBA32 atlas. The view swizzles it back to white plus alpha
+	// so none of the fragment shaders need to know which format is bound
+	const vk::Format atlas_format = Settings::Instance()->ui_alpha_atlas ?
+		                                vk::Format::eR8Unorm :
+		                                vk::Format::eR8G8B8A8Unorm;
+
+	if (m_dynamic_glyphs)
+	{
+		m_glyph_cache.SetDistanceField(m_sdf_text);
+		m_glyph_cache.AddToAtlas(io.Fonts,
+		                         io.Fonts->GetGlyphRangesDefault(),
+		                         atlas_format == vk::Format::eR8Unorm ?
+			                         1 :
+			                         4);
+	}
+
+	m_font_tex = VkRes::Texture<VkRes::ETextureLoader::Imgui>(_device, _physical_device, _cmd, _queue, atlas_format);
+
+	if (m_dynamic_glyphs)
+	{
+		m_glyph_cache.OnAtlasBuilt(io.Fonts);
+		m_glyph_buffer = VkRes::RingBuffer(_frames_in_flight, vk::BufferUsageFlagBits::eTransferSrc, atom_size, 64 * 1024);
+	}
+
 	m_sampler = VkRes::Sampler<vk::Filter::eLinear>(_device, vk::SamplerAddressMode::eClampToEdge, 0.0f, VK_FALSE, 0.0f);
 
+	// Bindless keeps every texture in one update-after-bind array, the fallback gives each texture its own set
+	const auto& indexing = g_VkGenerator.DescriptorIndexingFeatures();
+	m_bindless           = Settings::Instance()->ui_bindless_textures &&
+		indexing.shaderSampledImageArrayNonUniformIndexing &&
+		indexing.descriptorBindingSampledImageUpdateAfterBind &&
+		indexing.descriptorBindingUpdateUnusedWhilePending &&
+		indexing.descriptorBindingPartiallyBound;
+
+	if (m_bindless)
+	{
+		const auto& limits = g_VkGenerator.DescriptorIndexingProperties();
+
+		m_bindless = limits.maxPerStageDescriptorUpdateAfterBindSamplers >= k_ui_texture_capacity &&
+			limits.maxPerStageDescriptorUpdateAfterBindSampledImages >= k_ui_texture_capacity &&
+			limits.maxDescriptorSetUpdateAfterBindSamplers >= k_ui_texture_capacity &&
+			limits.maxDescriptorSetUpdateAfterBindSampledImages >= k_ui_texture_capacity;
+	}
+
+	const uint32_t texture_sets = m_bindless ?
+		                              1 :
+		                              k_ui_texture_capacity;
+
+	// One more sampler for the composite set of the cached layer
+	const uint32_t layer_sets = m_cached_layer ?
+		                            1 :
+		                            0;
+
 	// Descriptor Pool Code
 	const std::vector<vk::DescriptorPoolSize> pool_sizes =
 	{
 		{
 			vk::DescriptorType::eCombinedImageSampler,
-			1,
+			k_ui_texture_capacity + layer_sets,
+		},
+		{
+			vk::DescriptorType::eStorageBuffer,
+			_frames_in_flight,
 		}
 	};
 
 	const vk::DescriptorPoolCreateInfo pool_create_info =
 	{
-		{},
-		1,
+		m_bindless ?
+			vk::DescriptorPoolCreateFlagBits::eUpdateAfterBindEXT :
+			vk::DescriptorPoolCreateFlags{},
+		texture_sets + _frames_in_flight + layer_sets,
 		pool_sizes.size(),
 		pool_sizes.data()
 	};
@@ -147,98 +476,393 @@ void UI::LoadResources(vk::Device              _device,
 		{
 			0,
 			vk::DescriptorType::eCombinedImageSampler,
-			1,
+			m_bindless ?
+				k_ui_texture_capacity :
+				1,
 			vk::ShaderStageFlagBits::eFragment,
 			nullptr
 		}
 	};
 
+	// Slots are written while earlier frames are still pending and most of them are never written at all.
+	// A pending frame never samples a slot being written, a released slot is only reused once no pending frame uses it
+	const vk::DescriptorBindingFlagsEXT binding_flags = vk::DescriptorBindingFlagBitsEXT::eUpdateAfterBind |
+		vk::DescriptorBindingFlagBitsEXT::eUpdateUnusedWhilePending |
+		vk::DescriptorBindingFlagBitsEXT::ePartiallyBound;
+
+	const vk::DescriptorSetLayoutBindingFlagsCreateInfoEXT binding_flags_info =
+	{
+		1,
+		&binding_flags
+	};
+
 	const vk::DescriptorSetLayoutCreateInfo desc_layout_info =
 	{
-		{},
+		m_bindless ?
+			vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPoolEXT :
+			vk::DescriptorSetLayoutCreateFlags{},
 		1,
 		set_bindings.data()
 	};
 
-	const auto layout_result = _device.createDescriptorSetLayout(&desc_layout_info, nullptr, &m_desc_set_layout);
+	vk::DescriptorSetLayoutCreateInfo layout_info = desc_layout_info;
+	if (m_bindless)
+	{
+		layout_info.pNext = &binding_flags_info;
+	}
+
+	const auto layout_result = _device.createDescriptorSetLayout(&layout_info, nullptr, &m_desc_set_layout);
 	assert(("Failed to create descriptor layout", layout_result == vk::Result::eSuccess));
 
-	// Descriptor Set Code
-	const vk::DescriptorSetAllocateInfo alloc_info =
+	// Slot 0 is always the font atlas, ImGui's default null TexID
+	if (m_textures.empty())
 	{
-		m_desc_pool,
-		1,
-		&m_desc_set_layout,
-	};
+		m_textures.resize(1);
+	}
 
-	const auto set_result = _device.allocateDescriptorSets(&alloc_info, &m_desc_set);
-	assert(("Failed to allocate descriptor sets", set_result == vk::Result::eSuccess));
+	m_textures[0].view    = m_font_tex.View();
+	m_textures[0].sampler = m_sampler.SamplerInstance();
+	m_textures[0].used    = true;
 
-	const vk::DescriptorImageInfo desc_image_info =
+	if (m_bindless)
 	{
-		m_sampler.SamplerInstance(),
-		m_font_tex.View(),
-		vk::ImageLayout::eShaderReadOnlyOptimal
-	};
+		// Descriptor Set Code
+		const vk::DescriptorSetAllocateInfo alloc_info =
+		{
+			m_desc_pool,
+			1,
+			&m_desc_set_layout,
+		};
+
+		const auto set_result = _device.allocateDescriptorSets(&alloc_info, &m_desc_set);
+		assert(("Failed to allocate descriptor sets", set_result == vk::Result::eSuccess));
+	}
 
-	const std::vector<vk::WriteDescriptorSet> write_desc_sets =
+	for (uint32_t slot = 0 ; slot < m_textures.size() ; ++slot)
 	{
+		if (m_textures[slot].used)
+		{
+			WriteTextureDescriptor(_device, slot);
+		}
+	}
+
+	if (!m_bindless)
+	{
+		m_desc_set = m_textures[0].set;
+	}
+
+	// Same atlas under a second ImTextureID, shown in the example window to exercise texture switching
+	m_atlas_preview = RegisterTexture(_device, m_font_tex.View());
+
+	// Per frame draw data buffer for the indirect path, written once the buffers exist
+	std::vector<vk::DescriptorSetLayout> set_layouts = {m_desc_set_layout};
+
+	if (m_indirect_draw)
+	{
+		const vk::DescriptorSetLayoutBinding draw_binding =
 		{
-			m_desc_set,
-			0,
 			0,
+			vk::DescriptorType::eStorageBuffer,
 			1,
-			vk::DescriptorType::eCombinedImageSampler,
-			&desc_image_info,
-			nullptr,
+			vk::ShaderStageFlagBits::eVertex,
 			nullptr
-		}
-	};
+		};
+
+		const vk::DescriptorSetLayoutCreateInfo draw_layout_info =
+		{
+			{},
+			1,
+			&draw_binding
+		};
+
+		const auto draw_layout_result = _device.createDescriptorSetLayout(&draw_layout_info, nullptr, &m_draw_set_layout);
+		assert(("Failed to create descriptor layout", draw_layout_result == vk::Result::eSuccess));
+
+		const std::vector<vk::DescriptorSetLayout> draw_layouts(_frames_in_flight, m_draw_set_layout);
+
+		const vk::DescriptorSetAllocateInfo draw_alloc_info =
+		{
+			m_desc_pool,
+			_frames_in_flight,
+			draw_layouts.data()
+		};
+
+		m_draw_sets.resize(_frames_in_flight);
+		const auto draw_set_result = _device.allocateDescriptorSets(&draw_alloc_info, m_draw_sets.data());
+		assert(("Failed to allocate descriptor sets", draw_set_result == vk::Result::eSuccess));
+
+		m_draw_set_generations.assign(_frames_in_flight, 0);
+		set_layouts.push_back(m_draw_set_layout);
+	}
 
-	_device.updateDescriptorSets(write_desc_sets.size(), write_desc_sets.data(), 0, nullptr);
+	// The cached layer is single sampled and has its own pass, only the composite runs in the main pass
+	vk::RenderPass          ui_pass    = _pass;
+	vk::SampleCountFlagBits ui_samples = _samples;
+	uint32_t                ui_subpass = _subpass;
+
+	if (m_cached_layer)
+	{
+		CreateLayer(_device, _physical_device, _shader_dir, _cmd, _pass, _queue, _samples, _subpass);
+		ui_pass    = m_layer_pass.Pass();
+		ui_samples = vk::SampleCountFlagBits::e1;
+		ui_subpass = 0;
+	}
 
 	// Pipeline
+	const char* vert_name = "ui.vert.spv";
+	const char* frag_name = "ui.frag.spv";
+
+	if (m_indirect_draw)
+	{
+		vert_name = "ui_indirect.vert.spv";
+		frag_name = m_bindless ?
+			            "ui_indirect_bindless.frag.spv" :
+			            "ui_indirect.frag.spv";
+	}
+	else if (m_bindless)
+	{
+		frag_name = "ui_bindless.frag.spv";
+	}
+
 	m_vert = VkRes::Shader(_device,
 	                       vk::ShaderStageFlagBits::eVertex,
 	                       _shader_dir.data(),
-	                       "ui.vert.spv");
+	                       vert_name);
 
 	m_frag = VkRes::Shader(_device,
 	                       vk::ShaderStageFlagBits::eFragment,
 	                       _shader_dir.data(),
-	                       "ui.frag.spv");
+	                       frag_name);
 
-	const std::vector<vk::PipelineShaderStageCreateInfo> stages
+	std::vector<vk::PipelineShaderStageCreateInfo> stages
 	{
 		m_vert.Set(),
 		m_frag.Set()
 	};
 
+	// Every fragment shader variant decodes slot 0 as a distance field when this is set
+	const vk::Bool32                 distance_field = m_sdf_text ?
+		                                                  VK_TRUE :
+		                                                  VK_FALSE;
+	const vk::SpecializationMapEntry spec_entry     = {0, 0, sizeof(vk::Bool32)};
+	const vk::SpecializationInfo     spec_info      = {1, &spec_entry, sizeof(vk::Bool32), &distance_field};
+
+	stages[1].pSpecializationInfo = &spec_info;
+
 	const vk::VertexInputBindingDescription binding_desc =
 	{
 		0,
-		sizeof(ImDrawVert),
+		m_vertex_stride,
 		vk::VertexInputRate::eVertex
 	};
 
-	const std::vector<vk::VertexInputAttributeDescription> attri_desc =
-	{
-		{0, 0, vk::Format::eR32G32Sfloat, offsetof(ImDrawVert, pos)},
-		{1, 0, vk::Format::eR32G32Sfloat,offsetof(ImDrawVert, uv)},
-		{2, 0, vk::Format::eR8G8B8A8Unorm,offsetof(ImDrawVert, col)}
-	};
+	// The packed layout is expanded back to floats by the vertex fetch, ui.vert is shared by both
+	const std::vector<vk::VertexInputAttributeDescription> attri_desc = m_packed_vertices ?
+		std::vector<vk::VertexInputAttributeDescription>
+		{
+			{0, 0, vk::Format::eR16G16Snorm, offsetof(UIPackedVertex, pos)},
+			{1, 0, vk::Format::eR16G16Unorm, offsetof(UIPackedVertex, uv)},
+			{2, 0, vk::Format::eR8G8B8A8Unorm, offsetof(UIPackedVertex, col)}
+		} :
+		std::vector<vk::VertexInputAttributeDescription>
+		{
+			{0, 0, vk::Format::eR32G32Sfloat, offsetof(ImDrawVert, pos)},
+			{1, 0, vk::Format::eR32G32Sfloat,offsetof(ImDrawVert, uv)},
+			{2, 0, vk::Format::eR8G8B8A8Unorm,offsetof(ImDrawVert, col)}
+		};
 
 	m_pipeline.SetInputAssembler(&binding_desc, attri_desc, vk::PrimitiveTopology::eTriangleList, VK_FALSE);
 	m_pipeline.SetViewport({static_cast<uint32_t>(m_width), static_cast<uint32_t>(m_height)}, 0.0f, 1.0f);
-	m_pipeline.SetRasterizer(VK_TRUE, VK_TRUE, vk::CompareOp::eLess, _samples, VK_FALSE);
+	m_pipeline.SetRasterizer(VK_TRUE, VK_TRUE, vk::CompareOp::eLess, ui_samples, VK_FALSE);
+	if (m_cached_layer)
+	{
+		// The layer is composited later, so it has to keep premultiplied colour and accumulate coverage in alpha
+		m_pipeline.SetBlend(vk::BlendFactor::eSrcAlpha, vk::BlendFactor::eOneMinusSrcAlpha,
+		                    vk::BlendFactor::eOne, vk::BlendFactor::eOneMinusSrcAlpha);
+	}
 	m_pipeline.SetShaders(stages);
 	m_pipeline.SetPushConstants<UIPushConstantData>(0, vk::ShaderStageFlagBits::eVertex);
-	m_pipeline.CreatePipelineLayout(_device, &m_desc_set_layout, 1, 1);
-	m_pipeline.CreateGraphicPipeline(_device, _pass);
+	m_pipeline.CreatePipelineLayout(_device, set_layouts.data(), static_cast<uint32_t>(set_layouts.size()), 1);
+	m_pipeline.CreateGraphicPipeline(_device, ui_pass, ui_subpass);
+}
+
+void UI::CreateLayer(vk::Device              _device,
+                     vk::PhysicalDevice      _physical_device,
+                     std::string_view        _shader_dir,
+                     VkRes::Command          _cmd,
+                     vk::RenderPass          _pass,
+                     vk::Queue               _queue,
+                     vk::SampleCountFlagBits _samples,
+                     uint32_t                _subpass)
+{
+	const vk::Extent2D extent = {static_cast<uint32_t>(m_width), static_cast<uint32_t>(m_height)};
+	const vk::Format   format = vk::Format::eR8G8B8A8Unorm;
+
+	m_layer = VkRes::RenderTarget(_physical_device, _device, extent.width, extent.height, format,
+	                              vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal,
+	                              vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled,
+	                              vk::MemoryPropertyFlagBits::eDeviceLocal, vk::ImageLayout::eShaderReadOnlyOptimal,
+	                              _cmd, _queue);
+
+	// Between frames the layer is only sampled, the first frame clears all of it
+	VkRes::TransitionImageLayout(_device, _cmd, _queue, m_layer.GetImage(), format,
+	                             vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::eShaderReadOnlyOptimal, 1u);
+
+	// Load rather than clear, the pass only touches the damaged rect
+	vk::AttachmentDescription layer_desc = m_layer.GetAttachmentDesc();
+	layer_desc.setLoadOp(vk::AttachmentLoadOp::eLoad);
+	layer_desc.setInitialLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+
+	std::vector<vk::AttachmentDescription> attachments = {layer_desc};
+
+	vk::AttachmentReference colour_attachment =
+	{
+		0,
+		vk::ImageLayout::eColorAttachmentOptimal
+	};
+
+	// The last composite has to be done reading before the layer is drawn over, and the next one has to see the result
+	const std::vector<vk::SubpassDependency> dependencies =
+	{
+		{
+			VK_SUBPASS_EXTERNAL,
+			0,
+			vk::PipelineStageFlagBits::eFragmentShader,
+			vk::PipelineStageFlagBits::eColorAttachmentOutput,
+			vk::AccessFlagBits::eShaderRead,
+			vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite,
+			{}
+		},
+		{
+			0,
+			VK_SUBPASS_EXTERNAL,
+			vk::PipelineStageFlagBits::eColorAttachmentOutput,
+			vk::PipelineStageFlagBits::eFragmentShader,
+			vk::AccessFlagBits::eColorAttachmentWrite,
+			vk::AccessFlagBits::eShaderRead,
+			{}
+		}
+	};
+
+	m_layer_pass = VkRes::RenderPass(attachments,
+	                                 &colour_attachment,
+	                                 1,
+	                                 nullptr,
+	                                 nullptr,
+	                                 0,
+	                                 vk::PipelineBindPoint::eGraphics,
+	                                 _device,
+	                                 dependencies);
+
+	m_layer_framebuffer = VkRes::FrameBuffer(_device, {m_layer.GetImageView()}, m_layer_pass.Pass(), extent, 1);
+
+	// Composite set, just the layer
+	const vk::DescriptorSetLayoutBinding layer_binding =
+	{
+		0,
+		vk::DescriptorType::eCombinedImageSampler,
+		1,
+		vk::ShaderStageFlagBits::eFragment,
+		nullptr
+	};
+
+	const vk::DescriptorSetLayoutCreateInfo layer_layout_info =
+	{
+		{},
+		1,
+		&layer_binding
+	};
+
+	const auto layer_layout_result = _device.createDescriptorSetLayout(&layer_layout_info, nullptr, &m_layer_set_layout);
+	assert(("Failed to create descriptor layout", layer_layout_result == vk::Result::eSuccess));
+
+	const vk::DescriptorSetAllocateInfo layer_alloc_info =
+	{
+		m_desc_pool,
+		1,
+		&m_layer_set_layout
+	};
+
+	const auto layer_set_result = _device.allocateDescriptorSets(&layer_alloc_info, &m_layer_set);
+	assert(("Failed to allocate descriptor sets", layer_set_result == vk::Result::eSuccess));
+
+	const vk::DescriptorImageInfo layer_image_info =
+	{
+		m_sampler.SamplerInstance(),
+		m_layer.GetImageView(),
+		vk::ImageLayout::eShaderReadOnlyOptimal
+	};
+
+	const vk::WriteDescriptorSet layer_write =
+	{
+		m_layer_set,
+		0,
+		0,
+		1,
+		vk::DescriptorType::eCombinedImageSampler,
+		&layer_image_info,
+		nullptr,
+		nullptr
+	};
+
+	_device.updateDescriptorSets(1, &layer_write, 0, nullptr);
+
+	// Composite pipeline, a full screen triangle blending the premultiplied layer over the scene
+	m_composite_vert = VkRes::Shader(_device,
+	                                 vk::ShaderStageFlagBits::eVertex,
+	                                 _shader_dir.data(),
+	                                 "ui_composite.vert.spv");
+
+	m_composite_frag = VkRes::Shader(_device,
+	                                 vk::ShaderStageFlagBits::eFragment,
+	                                 _shader_dir.data(),
+	                                 "ui_composite.frag.spv");
+
+	m_composite_pipeline.SetInputAssembler(nullptr, {}, vk::PrimitiveTopology::eTriangleList, VK_FALSE);
+	m_composite_pipeline.SetViewport(extent, 0.0f, 1.0f);
+	m_composite_pipeline.SetRasterizer(VK_FALSE, VK_FALSE, vk::CompareOp::eAlways, _samples, VK_FALSE);
+	m_composite_pipeline.SetBlend(vk::BlendFactor::eOne, vk::BlendFactor::eOneMinusSrcAlpha,
+	                              vk::BlendFactor::eOne, vk::BlendFactor::eOneMinusSrcAlpha);
+	m_composite_pipeline.SetShaders({m_composite_vert.Set(), m_composite_frag.Set()});
+	m_composite_pipeline.CreatePipelineLayout(_device, &m_layer_set_layout, 1, 0);
+	m_composite_pipeline.CreateGraphicPipeline(_device, _pass, _subpass);
+
+	// The composite secondary only changes with the layer itself
+	m_composite_hash = Hash::Combine(Hash::Value(m_width), Hash::Value(m_height));
 }
 
-void UI::PrepNextFrame(float _delta, float _total_time)
+void UI::PrepNextFrame(float _delta, float _total_time, bool _input)
 {
+	const auto build_start = std::chrono::high_resolution_clock::now();
+
+	// The render thread keeps writing these, the windows below show the copy taken here. The time, stats and timings
+	// change every frame by themselves, so in idle mode they only refresh with input or the hash would never repeat
+	if (_input || !Settings::Instance()->idle_mode)
+	{
+		std::lock_guard<std::mutex> lock(m_shared_mutex);
+		m_shown_stats      = m_published_stats;
+		m_shown_benchmarks = m_benchmark_results;
+		m_shown_timings    = m_pipeline_timings;
+		m_shown_time       = _total_time;
+		m_shown_build_ms   = m_build_ms;
+		m_shown_publish_ms = m_publish_ms;
+		m_shown_skipped    = m_frames_skipped;
+	}
+
+	// Zooming only changes the quad size, a distance field atlas stays sharp without a rebuild
+	ImGui::GetIO().FontGlobalScale = m_text_zoom;
+
+	// Glyphs have to exist before NewFrame so this frame's text can already use them
+	if (m_dynamic_glyphs)
+	{
+		for (const ImWchar character : ImGui::GetIO().InputQueueCharacters)
+		{
+			m_glyph_cache.Request(character);
+		}
+
+		m_glyph_cache.Update();
+	}
+
 	ImGui::NewFrame();
 
 	// load but not save
@@ -249,16 +873,38 @@ void UI::PrepNextFrame(float _delta, float _total_time)
 		load_frame     = !load_frame;
 	}
 
+	// Text drawn from here to ImGui::Render is requested, new glyphs are rasterized before the next NewFrame
+	if (m_dynamic_glyphs)
+	{
+		m_glyph_cache.BeginCapture();
+	}
+
 	std::string cursor = "x: " + std::to_string(ImGui::GetMousePos().x) + " | y: " + std::to_string(ImGui::GetMousePos().y);
 	ImGui::TextUnformatted(cursor.c_str());
 
-	std::string time = "time: " + std::to_string(_total_time);
+	std::string time = "time: " + std::to_string(m_shown_time);
 	ImGui::TextUnformatted(time.c_str());
 
 	ImGui::SetNextWindowSize(ImVec2(0, 0), ImGuiSetCond_FirstUseEver);
 	ImGui::Begin("Settings");
 	ImGui::Checkbox("Enable Multi-sampling", &local_settings.use_msaa);
 	ImGui::SliderInt("Sample Level", &local_settings.sample_level, 2, 8);
+	ImGui::Checkbox("Indirect UI draw", &local_settings.ui_indirect_draw);
+	ImGui::Checkbox("Packed UI vertices", &local_settings.ui_packed_vertices);
+	ImGui::Checkbox("Staged UI upload", &local_settings.ui_staged_upload);
+	ImGui::Checkbox("Bindless UI textures", &local_settings.ui_bindless_textures);
+	ImGui::Checkbox("Dynamic UI glyphs", &local_settings.ui_dynamic_glyphs);
+	ImGui::Checkbox("SDF UI text", &local_settings.ui_sdf_text);
+	if (!m_glyph_cache.Loaded())
+	{
+		ImGui::TextDisabled("No font file loaded, dynamic glyphs and SDF text are off");
+	}
+	ImGui::SliderFloat("UI text zoom", &m_text_zoom, 0.5f, 4.0f);
+	ImGui::Checkbox("Alpha8 UI font atlas", &local_settings.ui_alpha_atlas);
+	ImGui::Checkbox("Cached UI layer", &local_settings.ui_cached_layer);
+	ImGui::Checkbox("Idle when unchanged", &local_settings.idle_mode);
+	ImGui::Checkbox("Incremental present", &local_settings.incremental_present);
+	ImGui::Checkbox("Parallel recording", &local_settings.parallel_recording);
 	ImGui::End();
 
 	ImGui::SetNextWindowSize(ImVec2(200, 200), ImGuiSetCond_FirstUseEver);
@@ -270,15 +916,285 @@ void UI::PrepNextFrame(float _delta, float _total_time)
 	ImGui::SliderFloat("z", &UIDemoUBOData.z, 0.0f, 100.0f);
 	ImGui::SliderFloat("w", &UIDemoUBOData.w, 0.0f, 100.0f);
 
-	ImGui::End();
+	ImGui::Text("Font atlas through a second texture id");
+	ImGui::Image(m_atlas_preview, ImVec2(128.0f, 64.0f));
 
-	ImGui::SetNextWindowPos(ImVec2(650, 20), ImGuiSetCond_FirstUseEver);
-	ImGui::ShowDemoWindow();
+	if (m_dynamic_glyphs)
+	{
+		// Outside the baked ranges, drawn with the fallback glyph for the first frame it is drawn in
+		ImGui::TextUnformatted(u8"\u4f60\u597d \u041f\u0440\u0438\u0432\u0435\u0442 \u03b1\u03b2\u03b3");
+	}
 
-	UpdateSettings();
+	ImGui::End();
 
-	ImGui::Render();
-}
+	ImGui::SetNextWindowPos(ImVec2(20, 300), ImGuiSetCond_FirstUseEver);
+	ImGui::SetNextWindowSize(ImVec2(0, 0), ImGuiSetCond_FirstUseEver);
+	ImGui::Begin("Renderer Stats");
+	ImGui::Text("UI lists uploaded: %u | skipped: %u", m_shown_stats.lists_uploaded, m_shown_stats.lists_skipped);
+	ImGui::Text("UI bytes uploaded: %llu | skipped: %llu",
+	            static_cast<unsigned long long>(m_shown_stats.bytes_uploaded),
+	            static_cast<unsigned long long>(m_shown_stats.bytes_skipped));
+	ImGui::Text("UI draw commands: %u | culled: %u | draw calls: %u (%s)",
+	            m_shown_stats.draw_commands, m_shown_stats.culled_commands, m_shown_stats.draw_calls,
+	            m_indirect_draw ? "indirect" : "direct");
+	ImGui::Text("UI geometry: %s", m_staged_upload ? "device local, staged" : "host visible");
+	ImGui::Text("UI textures: %s", m_bindless ? "bindless array" : "set per texture");
+	ImGui::Text("UI glyphs: %s", m_sdf_text ? "distance field" : m_dynamic_glyphs ? "dynamic" : "baked");
+	ImGui::Text("UI font atlas: %dx%d %s, %llu KB",
+	            ImGui::GetIO().Fonts->TexWidth, ImGui::GetIO().Fonts->TexHeight,
+	            m_font_tex.Format() == vk::Format::eR8Unorm ? "R8" : "RGBA8",
+	            static_cast<unsigned long long>(m_font_tex.MemorySize() / 1024));
+	const double screen = static_cast<double>(m_width) * static_cast<double>(m_height);
+	ImGui::Text("UI damage: %llu px (%.1f%%)%s",
+	            static_cast<unsigned long long>(m_shown_stats.damage_pixels),
+	            screen > 0.0 ? 100.0 * static_cast<double>(m_shown_stats.damage_pixels) / screen : 0.0,
+	            m_cached_layer ? ", redrawn in the cached layer" : "");
+	if (m_dynamic_glyphs)
+	{
+		ImGui::Text("UI cached glyphs: %u%s", m_glyph_cache.GlyphCount(), m_glyph_cache.Full() ? " (full)" : "");
+	}
+	if (Settings::Instance()->idle_mode)
+	{
+		ImGui::Text("Idle frames skipped: %llu", static_cast<unsigned long long>(m_shown_skipped));
+	}
+
+	ImGui::Checkbox("Parallel upload", &local_settings.ui_parallel_upload);
+	if (ImGui::Button("Run upload benchmark"))
+	{
+		// Shares the upload state with UI::Update, so it runs on the render thread with the next snapshot
+		m_benchmark_requested = true;
+	}
+
+	for (const auto& result : m_shown_benchmarks)
+	{
+		ImGui::Text("%3u lists: serial %.2f GB/s | parallel %.2f GB/s (%u workers)",
+		            result.list_count, result.serial_gbps, result.parallel_gbps, result.workers);
+	}
+	ImGui::End();
+
+	ImGui::SetNextWindowPos(ImVec2(20, 520), ImGuiSetCond_FirstUseEver);
+	ImGui::SetNextWindowSize(ImVec2(0, 0), ImGuiSetCond_FirstUseEver);
+	ImGui::Begin("Frame pipeline");
+	DrawPipelineTimings();
+	ImGui::End();
+
+	ImGui::SetNextWindowPos(ImVec2(650, 20), ImGuiSetCond_FirstUseEver);
+	ImGui::ShowDemoWindow();
+
+	UpdateSettings();
+
+	if (m_dynamic_glyphs)
+	{
+		m_glyph_cache.EndCapture();
+	}
+
+	ImGui::Render();
+
+	m_content_hash = 0;
+
+	if (Settings::Instance()->idle_mode)
+	{
+		const ImDrawData* draw_data = ImGui::GetDrawData();
+
+		m_content_hash = Hash::Value(draw_data->DisplaySize);
+		m_content_hash = Hash::Combine(m_content_hash, Hash::Value(m_texture_generation));
+
+		for (int i = 0 ; i < draw_data->CmdListsCount ; ++i)
+		{
+			m_content_hash = Hash::Combine(m_content_hash, HashDrawList(draw_data->CmdLists[i]));
+		}
+	}
+
+	const std::chrono::duration<double, std::milli> build_time = std::chrono::high_resolution_clock::now() - build_start;
+	m_build_ms = build_time.count();
+}
+
+// Shape of the upload benchmark, every pass uploads a prefix of the same synthetic lists
+constexpr uint32_t k_benchmark_max_lists     = 256;
+constexpr uint32_t k_benchmark_list_counts[] = {1, 4, 16, 64, k_benchmark_max_lists};
+constexpr int      k_benchmark_vertices      = 4096;
+constexpr int      k_benchmark_indices       = k_benchmark_vertices * 3 / 2;
+
+// Built on the main thread, ImDrawList allocates through ImGui and needs its shared data
+static void BuildBenchmarkLists(std::vector<std::unique_ptr<ImDrawList>>& _lists)
+{
+	for (uint32_t i = 0 ; i < k_benchmark_max_lists ; ++i)
+	{
+		_lists.push_back(std::make_unique<ImDrawList>(ImGui::GetDrawListSharedData()));
+
+		ImDrawList* list = _lists.back().get();
+		list->VtxBuffer.resize(k_benchmark_vertices);
+		list->IdxBuffer.resize(k_benchmark_indices);
+
+		for (int v = 0 ; v < k_benchmark_vertices ; ++v)
+		{
+			const float x      = static_cast<float>((v * 7 + i) % 1920);
+			const float y      = static_cast<float>((v * 13 + i) % 1080);
+			list->VtxBuffer[v] = {{x, y}, {x / 1920.0f, y / 1080.0f}, 0xFFFFFFFF};
+		}
+
+		for (int n = 0 ; n < k_benchmark_indices ; ++n)
+		{
+			list->IdxBuffer[n] = static_cast<ImDrawIdx>(n % k_benchmark_vertices);
+		}
+	}
+}
+
+// Resizes without giving memory back, unlike ImVector's assignment
+template <typename T> static void CopyImVector(ImVector<T>& _dst, const ImVector<T>& _src)
+{
+	_dst.resize(_src.Size);
+	if (_src.Size > 0)
+	{
+		std::memcpy(_dst.Data, _src.Data, static_cast<size_t>(_src.Size) * sizeof(T));
+	}
+}
+
+void UI::PublishFrame()
+{
+	const auto publish_start = std::chrono::high_resolution_clock::now();
+
+	{
+		std::lock_guard<std::mutex> lock(m_shared_mutex);
+		assert(("The render thread has not taken the previous snapshot", !m_snapshot_pending));
+	}
+
+	FrameSnapshot&    snapshot  = m_snapshots[m_build_snapshot];
+	const ImDrawData* draw_data = ImGui::GetDrawData();
+	const auto        count     = static_cast<size_t>(draw_data->CmdListsCount);
+
+	// Lists are kept from earlier snapshots, so steady state only copies the buffers
+	while (snapshot.lists.size() < count)
+	{
+		snapshot.lists.push_back(std::make_unique<ImDrawList>(ImGui::GetDrawListSharedData()));
+	}
+
+	snapshot.list_pointers.resize(count);
+
+	for (size_t i = 0 ; i < count ; ++i)
+	{
+		const ImDrawList* src = draw_data->CmdLists[i];
+		ImDrawList*       dst = snapshot.lists[i].get();
+
+		CopyImVector(dst->CmdBuffer, src->CmdBuffer);
+		CopyImVector(dst->IdxBuffer, src->IdxBuffer);
+		CopyImVector(dst->VtxBuffer, src->VtxBuffer);
+		dst->Flags      = src->Flags;
+		dst->_OwnerName = src->_OwnerName; // damage tracking identifies lists by it
+
+		snapshot.list_pointers[i] = dst;
+	}
+
+	snapshot.draw_data          = *draw_data;
+	snapshot.draw_data.CmdLists = snapshot.list_pointers.data();
+	snapshot.parallel_upload    = m_parallel_upload;
+	snapshot.run_benchmark      = m_benchmark_requested;
+	m_benchmark_requested       = false;
+
+	// The render thread is done with this snapshot, so the lists of an earlier run can be freed here
+	snapshot.benchmark_lists.clear();
+	if (snapshot.run_benchmark)
+	{
+		BuildBenchmarkLists(snapshot.benchmark_lists);
+	}
+
+	// The cache keeps rasterizing while the next frame is built, so this frame's new glyphs travel as pixels
+	snapshot.glyph_rects.clear();
+	snapshot.glyph_pixels.clear();
+
+	if (m_glyph_reupload.exchange(false) && m_dynamic_glyphs)
+	{
+		m_glyph_cache.MarkAllDirty();
+	}
+
+	if (m_dynamic_glyphs)
+	{
+		const uint32_t bytes_per_pixel = m_glyph_cache.BytesPerPixel();
+		const uint32_t region_pitch    = m_glyph_cache.RegionSize() * bytes_per_pixel;
+
+		for (const auto& rect : m_glyph_cache.Dirty())
+		{
+			const uint8_t* src       = m_glyph_cache.Pixels() + rect.y * region_pitch + rect.x * bytes_per_pixel;
+			const uint32_t row_bytes = rect.width * bytes_per_pixel;
+
+			for (uint32_t row = 0 ; row < rect.height ; ++row)
+			{
+				snapshot.glyph_pixels.insert(snapshot.glyph_pixels.end(), src + row * region_pitch, src + row * region_pitch + row_bytes);
+			}
+
+			snapshot.glyph_rects.push_back(rect);
+		}
+
+		m_glyph_cache.ClearDirty();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_shared_mutex);
+		m_snapshot_pending = true;
+	}
+
+	m_build_snapshot ^= 1;
+
+	const std::chrono::duration<double, std::milli> publish_time = std::chrono::high_resolution_clock::now() - publish_start;
+	m_publish_ms = publish_time.count();
+}
+
+bool UI::TakeFrame()
+{
+	std::lock_guard<std::mutex> lock(m_shared_mutex);
+
+	if (!m_snapshot_pending)
+	{
+		return false;
+	}
+
+	m_render_snapshot ^= 1;
+	m_snapshot_pending = false;
+	return true;
+}
+
+void UI::SetPipelineTimings(const std::vector<JobSystem::Timing>& _timings, uint32_t _graph_thread)
+{
+	std::lock_guard<std::mutex> lock(m_shared_mutex);
+	m_pipeline_timings      = _timings;
+	m_pipeline_graph_thread = _graph_thread;
+}
+
+// One row per stage of the last frame graph, with a bar placing it on the graph's timeline
+void UI::DrawPipelineTimings() const
+{
+	ImGui::Text("Main thread: UI build %.2f ms | snapshot %.2f ms", m_shown_build_ms, m_shown_publish_ms);
+
+	double span = 0.0;
+	for (const auto& timing : m_shown_timings)
+	{
+		span = std::max(span, timing.end);
+	}
+
+	ImDrawList* draw_list  = ImGui::GetWindowDrawList();
+	const float bar_width  = 200.0f;
+	const float bar_height = ImGui::GetTextLineHeight();
+
+	for (const auto& timing : m_shown_timings)
+	{
+		const std::string thread = timing.thread == m_pipeline_graph_thread ?
+			                           "render" :
+			                           "worker " + std::to_string(timing.thread);
+
+		ImGui::Text("%-12s %-9s %7.2f - %7.2f ms", timing.name, thread.c_str(), timing.begin, timing.end);
+		ImGui::SameLine();
+
+		const ImVec2 origin = ImGui::GetCursorScreenPos();
+		const float  begin  = span > 0.0 ? static_cast<float>(timing.begin / span) * bar_width : 0.0f;
+		const float  end    = span > 0.0 ? static_cast<float>(timing.end / span) * bar_width : 0.0f;
+
+		draw_list->AddRectFilled(origin, ImVec2(origin.x + bar_width, origin.y + bar_height), IM_COL32(60, 60, 60, 255));
+		draw_list->AddRectFilled(ImVec2(origin.x + begin, origin.y),
+		                         ImVec2(origin.x + std::max(end, begin + 1.0f), origin.y + bar_height),
+		                         timing.thread == m_pipeline_graph_thread ? IM_COL32(230, 160, 60, 255) : IM_COL32(80, 170, 230, 255));
+		ImGui::Dummy(ImVec2(bar_width, bar_height));
+	}
+}
 
 void UI::UpdateSettings()
 {
@@ -292,124 +1208,1045 @@ void UI::UpdateSettings()
 	}
 
 	Settings::Instance()->SetMSAA(local_settings.use_msaa);
+	Settings::Instance()->SetIndirectDraw(local_settings.ui_indirect_draw);
+	Settings::Instance()->SetPackedVertices(local_settings.ui_packed_vertices);
+	Settings::Instance()->SetParallelUpload(local_settings.ui_parallel_upload);
+	Settings::Instance()->SetStagedUpload(local_settings.ui_staged_upload);
+	Settings::Instance()->SetBindlessTextures(local_settings.ui_bindless_textures);
+	Settings::Instance()->SetDynamicGlyphs(local_settings.ui_dynamic_glyphs);
+	Settings::Instance()->SetAlphaAtlas(local_settings.ui_alpha_atlas);
+	Settings::Instance()->SetSdfText(local_settings.ui_sdf_text);
+	Settings::Instance()->SetCachedLayer(local_settings.ui_cached_layer);
+	Settings::Instance()->SetIdleMode(local_settings.idle_mode);
+	Settings::Instance()->SetIncrementalPresent(local_settings.incremental_present);
+	Settings::Instance()->SetParallelRecording(local_settings.parallel_recording);
+	m_parallel_upload = Settings::Instance()->ui_parallel_upload;
 }
 
-void UI::Update(vk::Device _device, vk::PhysicalDevice _physical_device)
+void UI::Update(vk::Device _device, vk::PhysicalDevice _physical_device, uint32_t _frame)
 {
-	const ImDrawData* imDrawData = ImGui::GetDrawData();
+	const FrameSnapshot& snapshot   = m_snapshots[m_render_snapshot];
+	const ImDrawData*    imDrawData = &snapshot.draw_data;
+
+	if (snapshot.run_benchmark)
+	{
+		RunUploadBenchmark(snapshot.benchmark_lists);
+	}
 
-	const vk::DeviceSize vertex_buffer_size = imDrawData->TotalVtxCount * sizeof(ImDrawVert);
-	const vk::DeviceSize index_buffer_size  = imDrawData->TotalIdxCount * sizeof(ImDrawVert);
+	m_frame_index  = _frame;
+	m_vertex_count = imDrawData->TotalVtxCount;
+	m_index_count  = imDrawData->TotalIdxCount;
+	m_stats        = {};
+	m_draw_batches.clear();
+
+	m_draw_hash = Hash::Value(m_width);
+	m_draw_hash = Hash::Combine(m_draw_hash, Hash::Value(m_height));
+	m_draw_hash = Hash::Combine(m_draw_hash, Hash::Value(m_frame_index));
+	m_draw_hash = Hash::Combine(m_draw_hash, Hash::Value(imDrawData->CmdListsCount));
+	m_draw_hash = Hash::Combine(m_draw_hash, Hash::Value(m_texture_generation));
+
+	StageGlyphs(_device, _physical_device);
+
+	const vk::DeviceSize vertex_buffer_size = m_vertex_count * m_vertex_stride;
+	const vk::DeviceSize index_buffer_size  = m_index_count * sizeof(ImDrawIdx);
 
 	if (vertex_buffer_size == 0 || index_buffer_size == 0)
 	{
+		// Nothing left to draw, but whatever was drawn last frame is now damage
+		m_pending_records.clear();
+		UpdateDamage(imDrawData);
+		PublishStats();
 		return;
 	}
 
-	if (!m_vertex_buffer.HasBufferData() || vertex_buffer_size != imDrawData->TotalVtxCount)
+	auto& records = m_upload_records[m_frame_index];
+
+	// Only reallocates when this frame's slot is too small, steady state never touches the allocator
+	const bool vertex_realloc = m_vertex_buffer.Reserve(_device, _physical_device, m_frame_index, vertex_buffer_size);
+	const bool index_realloc  = m_index_buffer.Reserve(_device, _physical_device, m_frame_index, index_buffer_size);
+
+	if (vertex_realloc || index_realloc)
+	{
+		records.clear();
+	}
+
+	m_draw_hash = Hash::Combine(m_draw_hash, Hash::Value(m_vertex_buffer.Generation(m_frame_index)));
+	m_draw_hash = Hash::Combine(m_draw_hash, Hash::Value(m_index_buffer.Generation(m_frame_index)));
+
+	// A fresh device local slot is empty, so every list has to go through staging again
+	if (m_staged_upload)
 	{
-		m_vertex_buffer.Destroy(_device);
+		const bool device_vertex_realloc = m_device_vertex_buffer.Reserve(_device, _physical_device, m_frame_index, vertex_buffer_size);
+		const bool device_index_realloc  = m_device_index_buffer.Reserve(_device, _physical_device, m_frame_index, index_buffer_size);
+
+		if (device_vertex_realloc || device_index_realloc)
+		{
+			records.clear();
+		}
+
+		m_draw_hash = Hash::Combine(m_draw_hash, Hash::Value(m_device_vertex_buffer.Generation(m_frame_index)));
+		m_draw_hash = Hash::Combine(m_draw_hash, Hash::Value(m_device_index_buffer.Generation(m_frame_index)));
+	}
+
+	records.resize(imDrawData->CmdListsCount);
 
-		m_vertex_buffer = VkRes::Buffer(_device, _physical_device, vertex_buffer_size, vk::BufferUsageFlagBits::eVertexBuffer);
-		m_vertex_count  = imDrawData->TotalVtxCount;
+	UploadDrawLists(imDrawData->CmdLists,
+	                imDrawData->CmdListsCount,
+	                static_cast<uint8_t*>(m_vertex_buffer.Data(m_frame_index)),
+	                static_cast<uint8_t*>(m_index_buffer.Data(m_frame_index)),
+	                records,
+	                snapshot.parallel_upload);
 
-		m_vertex_buffer.Unmap(_device);
+	m_vertex_buffer.Flush(_device, m_frame_index, m_vertex_ranges);
+	m_index_buffer.Flush(_device, m_frame_index, m_index_ranges);
 
-		m_vertex_buffer.Map(_device);
+	BuildDrawBatches(imDrawData);
+
+	UpdateDamage(imDrawData);
+
+	if (m_indirect_draw)
+	{
+		WriteIndirectDraws(_device, _physical_device);
 	}
 
-	if (!m_index_buffer.HasBufferData() || index_buffer_size != imDrawData->TotalIdxCount)
+	PublishStats();
+}
+
+void UI::PublishStats()
+{
+	std::lock_guard<std::mutex> lock(m_shared_mutex);
+	m_published_stats = m_stats;
+}
+
+// Compares every list with the previous frame. A changed list damages both where it was and where it is now,
+// anything that can change pixels without changing a list damages the whole screen
+void UI::UpdateDamage(const ImDrawData* _draw_data)
+{
+	const vk::Rect2D framebuffer = {{0, 0}, {static_cast<uint32_t>(m_width), static_cast<uint32_t>(m_height)}};
+	const size_t     list_count  = m_pending_records.size();
+
+	bool       full   = m_full_damage || list_count != m_damage_lists.size() || !m_glyph_copies.empty() ||
+		m_damage_texture_generation != m_texture_generation;
+	vk::Rect2D damage = {};
+
+	m_damage_lists.resize(list_count);
+
+	for (size_t i = 0 ; i < list_count ; ++i)
 	{
-		m_index_buffer.Destroy(_device);
+		const ImDrawList* cmd_list = _draw_data->CmdLists[i];
+		DamageList&       previous = m_damage_lists[i];
+		const DamageList  current  =
+		{
+			cmd_list->_OwnerName,
+			m_pending_records[i].hash,
+			ListBounds(cmd_list, framebuffer)
+		};
+
+		// Another window in this position means the stacking order changed
+		if (previous.owner != current.owner)
+		{
+			full = true;
+		}
+		else if (previous.hash != current.hash)
+		{
+			damage = Union(damage, Union(previous.bounds, current.bounds));
+		}
+
+		previous = current;
+	}
+
+	m_damage                    = full ?
+		                              framebuffer :
+		                              damage;
+	m_full_damage               = false;
+	m_damage_texture_generation = m_texture_generation;
+	m_stats.damage_pixels       = static_cast<uint64_t>(m_damage.extent.width) * m_damage.extent.height;
+}
+
+void UI::UploadDrawLists(ImDrawList* const*         _lists,
+                         int                        _count,
+                         uint8_t*                   _vtx_dst,
+                         uint8_t*                   _idx_dst,
+                         std::vector<UploadRecord>& _records,
+                         bool                       _parallel)
+{
+	m_pending_records.resize(_count);
+	m_list_uploaded.resize(_count);
+	m_vertex_ranges.clear();
+	m_index_ranges.clear();
 
-		m_index_buffer = VkRes::Buffer(_device, _physical_device, index_buffer_size, vk::BufferUsageFlagBits::eIndexBuffer);
-		m_index_count  = imDrawData->TotalIdxCount;
+	// Prefix sum of the list sizes gives every list its own region, so lists can be written in any order
+	uint32_t       vtx_offset   = 0;
+	uint32_t       idx_offset   = 0;
+	vk::DeviceSize source_bytes = 0;
 
-		m_index_buffer.Map(_device);
+	for (int i = 0 ; i < _count ; ++i)
+	{
+		m_pending_records[i] =
+		{
+			0,
+			vtx_offset,
+			idx_offset,
+			static_cast<uint32_t>(_lists[i]->VtxBuffer.Size),
+			static_cast<uint32_t>(_lists[i]->IdxBuffer.Size)
+		};
+
+		vtx_offset += m_pending_records[i].vtx_count;
+		idx_offset += m_pending_records[i].idx_count;
+		source_bytes += m_pending_records[i].vtx_count * sizeof(ImDrawVert) + m_pending_records[i].idx_count * sizeof(ImDrawIdx);
 	}
 
-	ImDrawVert* vtxDst = (ImDrawVert*)m_vertex_buffer.Data();
-	ImDrawIdx*  idxDst = (ImDrawIdx*)m_index_buffer.Data();
+	const auto upload_list = [&](uint32_t _index)
+	{
+		const ImDrawList* cmd_list = _lists[_index];
+		UploadRecord&     current  = m_pending_records[_index];
+
+		current.hash = HashDrawList(cmd_list);
+
+		// The slot still holds this exact list at this exact offset from its last use
+		if (_records[_index] == current)
+		{
+			m_list_uploaded[_index] = 0;
+			return;
+		}
+
+		if (m_packed_vertices)
+		{
+			UIVertex::Pack(cmd_list->VtxBuffer.Data,
+			               reinterpret_cast<UIPackedVertex*>(_vtx_dst + current.vtx_offset * m_vertex_stride),
+			               current.vtx_count);
+		}
+		else
+		{
+			std::memcpy(_vtx_dst + current.vtx_offset * m_vertex_stride,
+			            cmd_list->VtxBuffer.Data,
+			            current.vtx_count * m_vertex_stride);
+		}
+		std::memcpy(_idx_dst + current.idx_offset * sizeof(ImDrawIdx),
+		            cmd_list->IdxBuffer.Data,
+		            current.idx_count * sizeof(ImDrawIdx));
+
+		_records[_index]        = current;
+		m_list_uploaded[_index] = 1;
+	};
 
-	for (int i = 0 ; i < imDrawData->CmdListsCount ; ++i)
+	// Waking the workers costs more than hashing and copying a handful of small lists
+	if (_parallel && _count > 1 && source_bytes >= k_parallel_upload_threshold)
 	{
-		const ImDrawList* cmd_list = imDrawData->CmdLists[i];
-		std::memcpy(vtxDst, cmd_list->VtxBuffer.Data, cmd_list->VtxBuffer.Size * sizeof(ImDrawVert));
-		std::memcpy(idxDst, cmd_list->IdxBuffer.Data, cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx));
-		vtxDst += cmd_list->VtxBuffer.Size;
-		idxDst += cmd_list->IdxBuffer.Size;
+		if (m_upload_pool == nullptr)
+		{
+			m_upload_pool = std::make_unique<ThreadPool>(ThreadPool::DefaultWorkerCount());
+		}
+
+		m_upload_pool->ParallelFor(static_cast<uint32_t>(_count), upload_list);
+	}
+	else
+	{
+		for (int i = 0 ; i < _count ; ++i)
+		{
+			upload_list(static_cast<uint32_t>(i));
+		}
 	}
 
-	m_vertex_buffer.Flush(_device);
-	m_index_buffer.Flush(_device);
+	// Ranges, stats and the draw hash are gathered in list order so they match the serial path exactly
+	for (int i = 0 ; i < _count ; ++i)
+	{
+		const UploadRecord&  current   = m_pending_records[i];
+		const vk::DeviceSize vtx_bytes = current.vtx_count * m_vertex_stride;
+		const vk::DeviceSize idx_bytes = current.idx_count * sizeof(ImDrawIdx);
+
+		m_draw_hash = Hash::Combine(m_draw_hash, current.hash);
+
+		if (m_list_uploaded[i])
+		{
+			AppendRange(m_vertex_ranges, current.vtx_offset * m_vertex_stride, vtx_bytes);
+			AppendRange(m_index_ranges, current.idx_offset * sizeof(ImDrawIdx), idx_bytes);
+
+			m_stats.bytes_uploaded += vtx_bytes + idx_bytes;
+			++m_stats.lists_uploaded;
+		}
+		else
+		{
+			m_stats.bytes_skipped += vtx_bytes + idx_bytes;
+			++m_stats.lists_skipped;
+		}
+	}
 }
 
-void UI::Draw(VkRes::Command _cmd, int _cmd_index)
+// Times serial against parallel uploads of synthetic lists into host memory, results go to the stats window.
+// The lists come with the snapshot, so nothing here touches ImGui
+void UI::RunUploadBenchmark(const std::vector<std::unique_ptr<ImDrawList>>& _lists)
+{
+	constexpr int repeats = 16;
+
+	std::vector<BenchmarkResult> results;
+	std::vector<ImDrawList*>     lists;
+
+	for (const auto& list : _lists)
+	{
+		lists.push_back(list.get());
+	}
+
+	for (const uint32_t list_count : k_benchmark_list_counts)
+	{
+		std::vector<uint8_t>      vtx_dst(static_cast<size_t>(list_count) * k_benchmark_vertices * m_vertex_stride);
+		std::vector<uint8_t>      idx_dst(static_cast<size_t>(list_count) * k_benchmark_indices * sizeof(ImDrawIdx));
+		std::vector<UploadRecord> records;
+
+		const double bytes = static_cast<double>(list_count) *
+			(k_benchmark_vertices * sizeof(ImDrawVert) + k_benchmark_indices * sizeof(ImDrawIdx)) * repeats;
+
+		const auto measure = [&](bool _parallel)
+		{
+			const auto start = std::chrono::high_resolution_clock::now();
+			for (int r = 0 ; r < repeats ; ++r)
+			{
+				// Forget the previous pass so every list is hashed and copied again
+				records.assign(list_count, {});
+				UploadDrawLists(lists.data(), static_cast<int>(list_count), vtx_dst.data(), idx_dst.data(), records, _parallel);
+			}
+			const std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+			return bytes / elapsed.count() / (1024.0 * 1024.0 * 1024.0);
+		};
+
+		const double serial   = measure(false);
+		const double parallel = measure(true);
+
+		results.push_back({list_count, serial, parallel, m_upload_pool != nullptr ? m_upload_pool->WorkerCount() : 0});
+	}
+
+	std::lock_guard<std::mutex> lock(m_shared_mutex);
+	m_benchmark_results = std::move(results);
+}
+
+void UI::BuildDrawBatches(const ImDrawData* _draw_data)
+{
+	const vk::Rect2D framebuffer = {{0, 0}, {static_cast<uint32_t>(m_width), static_cast<uint32_t>(m_height)}};
+
+	int32_t  vertex_offset = 0;
+	uint32_t index_offset  = 0;
+
+	for (int i = 0 ; i < _draw_data->CmdListsCount ; ++i)
+	{
+		const ImDrawList* cmd_list   = _draw_data->CmdLists[i];
+		uint32_t          list_index = 0;
+		bool              can_merge  = false; // batches never cross draw lists, each has its own base vertex
+
+		for (const ImDrawCmd& cmd : cmd_list->CmdBuffer)
+		{
+			++m_stats.draw_commands;
+
+#ifdef UI_HAS_VTX_OFFSET
+			// Lists above 64K vertices are split by ImGui into commands with their own vertex base
+			const uint32_t cmd_vtx_offset = cmd.VtxOffset;
+			list_index                    = cmd.IdxOffset;
+#else
+			const uint32_t cmd_vtx_offset = 0;
+#endif
+
+			const float x0 = std::max(cmd.ClipRect.x, 0.0f);
+			const float y0 = std::max(cmd.ClipRect.y, 0.0f);
+			const float x1 = std::min(cmd.ClipRect.z, static_cast<float>(framebuffer.extent.width));
+			const float y1 = std::min(cmd.ClipRect.w, static_cast<float>(framebuffer.extent.height));
+
+			const uint32_t first_index = list_index;
+			list_index += cmd.ElemCount;
+
+			// Empty, zero area or entirely off screen
+			if (cmd.ElemCount == 0 || x1 <= x0 || y1 <= y0)
+			{
+				++m_stats.culled_commands;
+				can_merge = false;
+				continue;
+			}
+
+			const vk::Rect2D scissor =
+			{
+				{static_cast<int32_t>(x0), static_cast<int32_t>(y0)},
+				{static_cast<uint32_t>(x1 - x0), static_cast<uint32_t>(y1 - y0)}
+			};
+
+			const int32_t cmd_vertex_offset = vertex_offset + static_cast<int32_t>(cmd_vtx_offset);
+
+			if (can_merge)
+			{
+				DrawBatch&     batch       = m_draw_batches.back();
+				const uint32_t batch_first = batch.first_index - index_offset;
+
+				// Merging also needs the indices to be contiguous and relative to the same base vertex
+				if (batch.texture == cmd.TextureId && batch.vertex_offset == cmd_vertex_offset &&
+					batch_first + batch.index_count == first_index)
+				{
+					if (batch.scissor == scissor ||
+						(Contains(batch.scissor, scissor) &&
+							GeometryInside(cmd_list, first_index, cmd.ElemCount, cmd_vtx_offset, scissor)))
+					{
+						batch.index_count += cmd.ElemCount;
+						continue;
+					}
+
+					if (Contains(scissor, batch.scissor) &&
+						GeometryInside(cmd_list, batch_first, batch.index_count, cmd_vtx_offset, batch.scissor))
+					{
+						batch.scissor = scissor;
+						batch.index_count += cmd.ElemCount;
+						continue;
+					}
+				}
+			}
+
+			m_draw_batches.push_back({scissor, cmd.TextureId, index_offset + first_index, cmd_vertex_offset, cmd.ElemCount});
+			can_merge = true;
+		}
+
+		vertex_offset += cmd_list->VtxBuffer.Size;
+		index_offset += cmd_list->IdxBuffer.Size;
+	}
+
+	m_stats.draw_calls = static_cast<uint32_t>(m_draw_batches.size());
+}
+
+void UI::WriteIndirectDraws(vk::Device _device, vk::PhysicalDevice _physical_device)
+{
+	const uint32_t       draw_count     = static_cast<uint32_t>(m_draw_batches.size());
+	const vk::DeviceSize indirect_bytes = draw_count * sizeof(vk::DrawIndexedIndirectCommand);
+	const vk::DeviceSize data_bytes     = draw_count * sizeof(IndirectDrawData);
+
+	if (draw_count == 0)
+	{
+		return;
+	}
+
+	m_indirect_buffer.Reserve(_device, _physical_device, m_frame_index, indirect_bytes);
+	m_draw_data_buffer.Reserve(_device, _physical_device, m_frame_index, data_bytes);
+
+	// The set only needs rewriting when the draw data slot was reallocated
+	const uint32_t data_generation = m_draw_data_buffer.Generation(m_frame_index);
+	if (m_draw_set_generations[m_frame_index] != data_generation)
+	{
+		const vk::DescriptorBufferInfo data_info =
+		{
+			m_draw_data_buffer.BufferData(m_frame_index),
+			0,
+			VK_WHOLE_SIZE
+		};
+
+		const vk::WriteDescriptorSet write_desc_set =
+		{
+			m_draw_sets[m_frame_index],
+			0,
+			0,
+			1,
+			vk::DescriptorType::eStorageBuffer,
+			nullptr,
+			&data_info,
+			nullptr
+		};
+
+		_device.updateDescriptorSets(1, &write_desc_set, 0, nullptr);
+		m_draw_set_generations[m_frame_index] = data_generation;
+	}
+
+	auto* draws = static_cast<vk::DrawIndexedIndirectCommand*>(m_indirect_buffer.Data(m_frame_index));
+	auto* data  = static_cast<IndirectDrawData*>(m_draw_data_buffer.Data(m_frame_index));
+
+	// firstInstance carries the batch index so the vertex shader can fetch its clip rect and texture
+	for (uint32_t i = 0 ; i < draw_count ; ++i)
+	{
+		const DrawBatch& batch = m_draw_batches[i];
+
+		draws[i] = vk::DrawIndexedIndirectCommand(batch.index_count, 1, batch.first_index, batch.vertex_offset, i);
+		data[i]  =
+		{
+			ImVec4(static_cast<float>(batch.scissor.offset.x),
+			       static_cast<float>(batch.scissor.offset.y),
+			       static_cast<float>(batch.scissor.offset.x + batch.scissor.extent.width),
+			       static_cast<float>(batch.scissor.offset.y + batch.scissor.extent.height)),
+			{TextureSlot(batch.texture), 0, 0, 0}
+		};
+	}
+
+	m_indirect_buffer.Flush(_device, m_frame_index, {{0, indirect_bytes}});
+	m_draw_data_buffer.Flush(_device, m_frame_index, {{0, data_bytes}});
+
+	m_draw_hash = Hash::Combine(m_draw_hash, Hash::Value(m_indirect_buffer.Generation(m_frame_index)));
+	m_draw_hash = Hash::Combine(m_draw_hash, Hash::Value(data_generation));
+
+	// Without bindless every texture change ends the current indirect draw to rebind the set
+	uint32_t draw_calls = 0;
+	for (uint32_t first = 0 ; first < draw_count ; )
+	{
+		const uint32_t run = m_bindless ?
+			                     draw_count - first :
+			                     TextureRun(first);
+
+		draw_calls += m_multi_draw_indirect ?
+			              (run + m_max_draw_indirect_count - 1) / m_max_draw_indirect_count :
+			              run;
+		first += run;
+	}
+	m_stats.draw_calls = draw_calls;
+}
+
+uint32_t UI::TextureSlot(ImTextureID _texture) const
+{
+	const auto slot = static_cast<uint32_t>(reinterpret_cast<intptr_t>(_texture));
+
+	// Unknown or released ids draw with the font atlas rather than an unwritten descriptor
+	return slot < m_textures.size() && m_textures[slot].used ?
+		       slot :
+		       0;
+}
+
+// Number of consecutive batches from _first that sample the same texture
+uint32_t UI::TextureRun(uint32_t _first) const
+{
+	uint32_t last = _first + 1;
+	while (last < m_draw_batches.size() && m_draw_batches[last].texture == m_draw_batches[_first].texture)
+	{
+		++last;
+	}
+	return last - _first;
+}
+
+ImTextureID UI::RegisterTexture(vk::Device _device, vk::ImageView _view, vk::Sampler _sampler)
+{
+	uint32_t slot = 1;
+
+	// Released slots are reused once no frame in flight can still be sampling them
+	while (slot < m_textures.size() && (m_textures[slot].used || !m_textures[slot].retired))
+	{
+		++slot;
+	}
+
+	assert(("Out of UI texture slots", slot < k_ui_texture_capacity));
+
+	if (slot == m_textures.size())
+	{
+		m_textures.emplace_back();
+	}
+
+	TextureEntry& texture = m_textures[slot];
+	texture.view          = _view;
+	texture.sampler       = _sampler != nullptr ?
+		                        _sampler :
+		                        m_sampler.SamplerInstance();
+	texture.used          = true;
+
+	if (m_desc_pool != nullptr)
+	{
+		WriteTextureDescriptor(_device, slot);
+	}
+
+	++m_texture_generation;
+	return ToTextureID(slot);
+}
+
+void UI::UnregisterTexture(ImTextureID _texture)
+{
+	const auto slot = static_cast<uint32_t>(reinterpret_cast<intptr_t>(_texture));
+	if (slot == 0 || slot >= m_textures.size())
+	{
+		return;
+	}
+
+	m_textures[slot].used = false;
+	m_textures[slot].view = nullptr;
+	++m_texture_generation;
+
+	if (m_scheduler == nullptr)
+	{
+		return;
+	}
+
+	// The frame being built may still draw it, so the slot waits for that submit to retire as well
+	m_textures[slot].retired = false;
+	m_scheduler->Defer([this, slot]()
+	{
+		m_textures[slot].retired = true;
+	});
+}
+
+void UI::SetScheduler(VkRes::FrameScheduler* _scheduler)
+{
+	m_scheduler = _scheduler;
+}
+
+void UI::WriteTextureDescriptor(vk::Device _device, uint32_t _slot)
+{
+	TextureEntry&     texture = m_textures[_slot];
+	vk::DescriptorSet set     = m_desc_set;
+	uint32_t          element = _slot;
+
+	if (!m_bindless)
+	{
+		if (texture.set == nullptr)
+		{
+			const vk::DescriptorSetAllocateInfo alloc_info =
+			{
+				m_desc_pool,
+				1,
+				&m_desc_set_layout,
+			};
+
+			const auto set_result = _device.allocateDescriptorSets(&alloc_info, &texture.set);
+			assert(("Failed to allocate descriptor sets", set_result == vk::Result::eSuccess));
+		}
+
+		set     = texture.set;
+		element = 0;
+	}
+
+	const vk::DescriptorImageInfo desc_image_info =
+	{
+		texture.sampler,
+		texture.view,
+		vk::ImageLayout::eShaderReadOnlyOptimal
+	};
+
+	const vk::WriteDescriptorSet write_desc_set =
+	{
+		set,
+		0,
+		element,
+		1,
+		vk::DescriptorType::eCombinedImageSampler,
+		&desc_image_info,
+		nullptr,
+		nullptr
+	};
+
+	_device.updateDescriptorSets(1, &write_desc_set, 0, nullptr);
+}
+
+void UI::InvalidateUploads()
+{
+	for (auto& records : m_upload_records)
+	{
+		records.clear();
+	}
+
+	// The cache belongs to the thread building frames, the next snapshot carries the whole region
+	m_glyph_reupload = true;
+
+	m_full_damage = true;
+}
+
+bool UI::SetDynamicFont(const std::string& _file, float _size_pixels, uint32_t _glyph_budget)
+{
+	return m_glyph_cache.Load(_file, _size_pixels, _glyph_budget);
+}
+
+void UI::RequestGlyphs(const char* _text)
+{
+	if (m_dynamic_glyphs)
+	{
+		m_glyph_cache.Request(_text);
+	}
+}
+
+void UI::StageGlyphs(vk::Device _device, vk::PhysicalDevice _physical_device)
+{
+	m_glyph_copies.clear();
+
+	const FrameSnapshot& snapshot = m_snapshots[m_render_snapshot];
+
+	if (!m_dynamic_glyphs || snapshot.glyph_rects.empty())
+	{
+		return;
+	}
+
+	const uint32_t bytes_per_pixel = m_glyph_cache.BytesPerPixel();
+
+	// bufferOffset has to be a multiple of 4 and of the texel size
+	const auto aligned_size = [bytes_per_pixel](const GlyphCache::Rect& _rect)
+	{
+		return (static_cast<vk::DeviceSize>(_rect.width) * _rect.height * bytes_per_pixel + 3) & ~vk::DeviceSize(3);
+	};
+
+	vk::DeviceSize staging_size = 0;
+	for (const auto& rect : snapshot.glyph_rects)
+	{
+		staging_size += aligned_size(rect);
+	}
+
+	m_glyph_buffer.Reserve(_device, _physical_device, m_frame_index, staging_size);
+
+	uint8_t*       staging = static_cast<uint8_t*>(m_glyph_buffer.Data(m_frame_index));
+	const uint8_t* src     = snapshot.glyph_pixels.data();
+	vk::DeviceSize offset  = 0;
+
+	// The snapshot packs every rect's rows tightly, so each one is a single copy
+	for (const auto& rect : snapshot.glyph_rects)
+	{
+		const size_t rect_bytes = static_cast<size_t>(rect.width) * rect.height * bytes_per_pixel;
+
+		std::memcpy(staging + offset, src, rect_bytes);
+		src += rect_bytes;
+
+		m_glyph_copies.push_back(
+		{
+			offset,
+			0,
+			0,
+			{vk::ImageAspectFlagBits::eColor, 0, 0, 1},
+			{
+				static_cast<int32_t>(m_glyph_cache.RegionX() + rect.x),
+				static_cast<int32_t>(m_glyph_cache.RegionY() + rect.y),
+				0
+			},
+			{rect.width, rect.height, 1}
+		});
+
+		offset += aligned_size(rect);
+	}
+
+	m_glyph_buffer.Flush(_device, m_frame_index, {{0, offset}});
+}
+
+void UI::RecordGlyphUpload(vk::CommandBuffer _cmd_buffer) const
+{
+	if (m_glyph_copies.empty())
+	{
+		return;
+	}
+
+	// Only the copied rectangles change, the rest of the atlas keeps its contents across the transitions
+	vk::ImageMemoryBarrier barrier =
+	{
+		vk::AccessFlagBits::eShaderRead,
+		vk::AccessFlagBits::eTransferWrite,
+		vk::ImageLayout::eShaderReadOnlyOptimal,
+		vk::ImageLayout::eTransferDstOptimal,
+		VK_QUEUE_FAMILY_IGNORED,
+		VK_QUEUE_FAMILY_IGNORED,
+		m_font_tex.Image(),
+		{vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}
+	};
+
+	_cmd_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eFragmentShader,
+	                            vk::PipelineStageFlagBits::eTransfer,
+	                            {},
+	                            0,
+	                            nullptr,
+	                            0,
+	                            nullptr,
+	                            1,
+	                            &barrier);
+
+	_cmd_buffer.copyBufferToImage(m_glyph_buffer.BufferData(m_frame_index),
+	                              m_font_tex.Image(),
+	                              vk::ImageLayout::eTransferDstOptimal,
+	                              static_cast<uint32_t>(m_glyph_copies.size()),
+	                              m_glyph_copies.data());
+
+	barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+	barrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+	barrier.setOldLayout(vk::ImageLayout::eTransferDstOptimal);
+	barrier.setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+
+	_cmd_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+	                            vk::PipelineStageFlagBits::eFragmentShader,
+	                            {},
+	                            0,
+	                            nullptr,
+	                            0,
+	                            nullptr,
+	                            1,
+	                            &barrier);
+}
+
+void UI::RecordUpload(vk::CommandBuffer _cmd_buffer) const
 {
-	ImGuiIO& io    = ImGui::GetIO();
-	io.DisplaySize = ImVec2(m_width, m_height);
+	RecordGlyphUpload(_cmd_buffer);
+
+	if (!m_staged_upload || (m_vertex_ranges.empty() && m_index_ranges.empty()))
+	{
+		return;
+	}
+
+	std::vector<vk::BufferMemoryBarrier> barriers;
+
+	const auto copy_ranges = [&](const VkRes::RingBuffer&                     _src,
+	                             const VkRes::RingBuffer&                     _dst,
+	                             const std::vector<VkRes::RingBuffer::Range>& _ranges,
+	                             vk::AccessFlags                              _dst_access)
+	{
+		if (_ranges.empty())
+		{
+			return;
+		}
+
+		std::vector<vk::BufferCopy> regions;
+		regions.reserve(_ranges.size());
+
+		for (const auto& range : _ranges)
+		{
+			regions.emplace_back(range.offset, range.offset, range.size);
+		}
+
+		_cmd_buffer.copyBuffer(_src.BufferData(m_frame_index),
+		                       _dst.BufferData(m_frame_index),
+		                       static_cast<uint32_t>(regions.size()),
+		                       regions.data());
+
+		barriers.emplace_back(vk::AccessFlagBits::eTransferWrite,
+		                      _dst_access,
+		                      VK_QUEUE_FAMILY_IGNORED,
+		                      VK_QUEUE_FAMILY_IGNORED,
+		                      _dst.BufferData(m_frame_index),
+		                      0,
+		                      VK_WHOLE_SIZE);
+	};
+
+	copy_ranges(m_vertex_buffer, m_device_vertex_buffer, m_vertex_ranges, vk::AccessFlagBits::eVertexAttributeRead);
+	copy_ranges(m_index_buffer, m_device_index_buffer, m_index_ranges, vk::AccessFlagBits::eIndexRead);
+
+	_cmd_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+	                            vk::PipelineStageFlagBits::eVertexInput,
+	                            {},
+	                            0,
+	                            nullptr,
+	                            static_cast<uint32_t>(barriers.size()),
+	                            barriers.data(),
+	                            0,
+	                            nullptr);
+}
+
+void UI::RecordLayer(vk::CommandBuffer _cmd_buffer)
+{
+	if (!m_cached_layer || Empty(m_damage))
+	{
+		return;
+	}
+
+	const vk::RenderPassBeginInfo begin_info =
+	{
+		m_layer_pass.Pass(),
+		m_layer_framebuffer.Buffer(),
+		m_damage,
+		0,
+		nullptr
+	};
+
+	_cmd_buffer.beginRenderPass(&begin_info, vk::SubpassContents::eInline);
+
+	// The rest of the layer is loaded untouched, only the damaged rect starts out transparent again
+	const vk::ClearAttachment clear_attachment =
+	{
+		vk::ImageAspectFlagBits::eColor,
+		0,
+		vk::ClearValue{}
+	};
+
+	const vk::ClearRect clear_rect =
+	{
+		m_damage,
+		0,
+		1
+	};
+
+	_cmd_buffer.clearAttachments(1, &clear_attachment, 1, &clear_rect);
 
-	_cmd.BindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_pipeline.PipelineLayout(), &m_desc_set, _cmd_index);
-	_cmd.BindPipeline(vk::PipelineBindPoint::eGraphics, m_pipeline.Pipeline(), _cmd_index);
+	RecordDraw(_cmd_buffer, m_damage, 0, static_cast<uint32_t>(m_draw_batches.size()));
 
+	_cmd_buffer.endRenderPass();
+}
+
+void UI::Draw(VkRes::Command _cmd, int _cmd_index)
+{
 	const vk::CommandBuffer cmd_buffer = _cmd.CommandBuffers()[_cmd_index];
 
+	if (m_cached_layer)
+	{
+		DrawComposite(cmd_buffer);
+		return;
+	}
+
+	RecordDraw(cmd_buffer, {{0, 0}, {static_cast<uint32_t>(m_width), static_cast<uint32_t>(m_height)}},
+	           0, static_cast<uint32_t>(m_draw_batches.size()));
+}
+
+uint32_t UI::DrawChunkCount(uint32_t _max_chunks) const
+{
+	if (m_cached_layer)
+	{
+		return 1;
+	}
+
+	const auto chunks = static_cast<uint32_t>(m_draw_batches.size()) / k_record_chunk_batches;
+	return std::max(std::min(chunks, _max_chunks), 1u);
+}
+
+void UI::DrawChunk(vk::CommandBuffer _cmd_buffer, uint32_t _chunk, uint32_t _chunk_count)
+{
+	if (m_cached_layer)
+	{
+		DrawComposite(_cmd_buffer);
+		return;
+	}
+
+	const auto batch_count = static_cast<uint32_t>(m_draw_batches.size());
+	const auto first       = batch_count * _chunk / _chunk_count;
+	const auto last        = batch_count * (_chunk + 1) / _chunk_count;
+
+	RecordDraw(_cmd_buffer, {{0, 0}, {static_cast<uint32_t>(m_width), static_cast<uint32_t>(m_height)}},
+	           first, last - first);
+}
+
+void UI::DrawComposite(vk::CommandBuffer _cmd_buffer)
+{
+	const vk::Viewport viewport =
+	{
+		0.0f,
+		0.0f,
+		m_width,
+		m_height,
+		0.0f,
+		1.0f
+	};
+
+	// Also keeps the fetch inside the layer if the swapchain grew since it was created
+	const vk::Rect2D scissor = {{0, 0}, {static_cast<uint32_t>(m_width), static_cast<uint32_t>(m_height)}};
+
+	_cmd_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, m_composite_pipeline.Pipeline());
+	_cmd_buffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_composite_pipeline.PipelineLayout(), 0, 1,
+	                               &m_layer_set, 0, nullptr);
+	_cmd_buffer.setViewport(0, 1, &viewport);
+	_cmd_buffer.setScissor(0, 1, &scissor);
+	_cmd_buffer.draw(3, 1, 0, 0);
+}
+
+// Draws every batch of the range that overlaps _area, clipped to it. Only reads UI state and never ImGui's,
+// so chunks can be recorded on several threads at once and while the next frame is being built
+void UI::RecordDraw(vk::CommandBuffer _cmd_buffer, const vk::Rect2D& _area, uint32_t _first_batch, uint32_t _batch_count)
+{
+	if (m_indirect_draw)
+	{
+		const vk::DescriptorSet sets[2] = {m_desc_set, m_draw_sets[m_frame_index]};
+		_cmd_buffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_pipeline.PipelineLayout(), 0, 2, sets, 0, nullptr);
+	}
+	else
+	{
+		_cmd_buffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_pipeline.PipelineLayout(), 0, 1, &m_desc_set, 0,
+		                               nullptr);
+	}
+
+	_cmd_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, m_pipeline.Pipeline());
+
 	vk::Viewport viewport =
 	{
 		0.0f,
 		0.0f,
-		ImGui::GetIO().DisplaySize.x,
-		ImGui::GetIO().DisplaySize.y,
+		m_width,
+		m_height,
 		0.0f,
 		1.0f
 	};
 
-	cmd_buffer.setViewport(0, 1, &viewport);
+	_cmd_buffer.setViewport(0, 1, &viewport);
 
-	UIPushConstants.xScale = 2.0f / ImGui::GetIO().DisplaySize.x;
-	UIPushConstants.yScale = 2.0f / ImGui::GetIO().DisplaySize.y;
-	UIPushConstants.xTrans = -1.0f;
-	UIPushConstants.yTrans = -1.0f;
+	// Packed positions arrive as snorm, scale them back up to pixels in the same multiply
+	const float position_scale = m_packed_vertices ?
+		                             UIVertex::k_position_decode :
+		                             1.0f;
 
-	_cmd.PushConstants<UIPushConstantData>(UIPushConstants, m_pipeline.PipelineLayout(), vk::ShaderStageFlagBits::eVertex,
-	                                       _cmd_index);
+	const UIPushConstantData push_constants =
+	{
+		2.0f / m_width * position_scale,
+		2.0f / m_height * position_scale,
+		-1.0f,
+		-1.0f
+	};
 
-	const ImDrawData* imDrawData    = ImGui::GetDrawData();
-	int32_t           vertex_offset = 0;
-	int32_t           index_offset  = 0;
+	_cmd_buffer.pushConstants(m_pipeline.PipelineLayout(), vk::ShaderStageFlagBits::eVertex, 0,
+	                          sizeof(UIPushConstantData), &push_constants);
 
-	if (imDrawData->CmdListsCount > 0)
+	if (_batch_count > 0)
 	{
-		vk::DeviceSize offsets[1] = {0};
+		vk::DeviceSize   offsets[1]    = {0};
+		const vk::Buffer vertex_buffer = m_staged_upload ?
+			                                 m_device_vertex_buffer.BufferData(m_frame_index) :
+			                                 m_vertex_buffer.BufferData(m_frame_index);
+		const vk::Buffer index_buffer  = m_staged_upload ?
+			                                 m_device_index_buffer.BufferData(m_frame_index) :
+			                                 m_index_buffer.BufferData(m_frame_index);
+
+		_cmd_buffer.bindVertexBuffers(0, 1, &vertex_buffer, offsets);
+		_cmd_buffer.bindIndexBuffer(index_buffer, 0, k_index_type);
+
+		if (m_indirect_draw)
+		{
+			DrawIndirect(_cmd_buffer, _area, _first_batch, _batch_count);
+		}
+		else
+		{
+			DrawDirect(_cmd_buffer, _area, _first_batch, _batch_count);
+		}
+	}
+}
 
-		cmd_buffer.bindVertexBuffers(0, 1, &m_vertex_buffer.BufferData(), offsets);
-		cmd_buffer.bindIndexBuffer(m_index_buffer.BufferData(), 0, vk::IndexType::eUint16);
+void UI::DrawDirect(vk::CommandBuffer _cmd_buffer, const vk::Rect2D& _area, uint32_t _first_batch, uint32_t _batch_count)
+{
+	uint32_t bound_slot = 0;
 
-		for (int i = 0 ; i < imDrawData->CmdListsCount ; ++i)
+	for (uint32_t i = _first_batch ; i < _first_batch + _batch_count ; ++i)
+	{
+		const DrawBatch& batch   = m_draw_batches[i];
+		const vk::Rect2D scissor = Intersect(batch.scissor, _area);
+		if (Empty(scissor))
 		{
-			const ImDrawList* cmd_list = imDrawData->CmdLists[i];
-			for (int j = 0 ; j < cmd_list->CmdBuffer.Size ; ++j)
-			{
-				const ImDrawCmd* cmd          = &cmd_list->CmdBuffer[j];
-				vk::Rect2D       scissor_rect =
-				{
-					{
-						std::max((int32_t)(cmd->ClipRect.x), 0),
-						std::max((int32_t)(cmd->ClipRect.y), 0)
-					},
-					{
-						(uint32_t)(cmd->ClipRect.z - cmd->ClipRect.x),
-						(uint32_t)(cmd->ClipRect.w - cmd->ClipRect.y)
-					}
-				};
+			continue;
+		}
+
+		const uint32_t slot = TextureSlot(batch.texture);
+
+		// The slot always travels in firstInstance, without bindless the set is switched as well
+		if (!m_bindless && slot != bound_slot)
+		{
+			_cmd_buffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_pipeline.PipelineLayout(), 0, 1,
+			                               &m_textures[slot].set, 0, nullptr);
+			bound_slot = slot;
+		}
+
+		_cmd_buffer.setScissor(0, 1, &scissor);
+		_cmd_buffer.drawIndexed(batch.index_count, 1, batch.first_index, batch.vertex_offset, slot);
+	}
+}
 
-				cmd_buffer.setScissor(0, 1, &scissor_rect);
-				cmd_buffer.drawIndexed(cmd->ElemCount, 1, index_offset, vertex_offset, 0);
+// Clipping happens in the fragment shader, so the whole UI goes out with a single scissor
+void UI::DrawIndirect(vk::CommandBuffer _cmd_buffer, const vk::Rect2D& _area, uint32_t _first_batch, uint32_t _batch_count)
+{
+	_cmd_buffer.setScissor(0, 1, &_area);
+
+	const vk::Buffer indirect_buffer = m_indirect_buffer.BufferData(m_frame_index);
+	const uint32_t   draw_end        = _first_batch + _batch_count;
+	const uint32_t   stride          = sizeof(vk::DrawIndexedIndirectCommand);
+	uint32_t         bound_slot      = 0;
+
+	for (uint32_t first = _first_batch ; first < draw_end ; )
+	{
+		uint32_t run = draw_end - first;
 
-				index_offset += cmd->ElemCount;
+		if (!m_bindless)
+		{
+			const uint32_t slot = TextureSlot(m_draw_batches[first].texture);
+			if (slot != bound_slot)
+			{
+				_cmd_buffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_pipeline.PipelineLayout(), 0, 1,
+				                               &m_textures[slot].set, 0, nullptr);
+				bound_slot = slot;
 			}
 
-			vertex_offset += cmd_list->VtxBuffer.Size;
+			run = std::min(TextureRun(first), run);
 		}
+
+		for (uint32_t offset = 0 ; offset < run ; offset += m_max_draw_indirect_count)
+		{
+			const uint32_t count = std::min(run - offset, m_max_draw_indirect_count);
+			_cmd_buffer.drawIndexedIndirect(indirect_buffer, (first + offset) * stride, count, stride);
+		}
+
+		first += run;
 	}
-}
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "include\UIVertex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define UI_VERTEX_SSE2 1
+#include <emmintrin.h>
+#endif
+
+static_assert(sizeof(ImDrawVert) == 20 && offsetof(ImDrawVert, uv) == 8 && offsetof(ImDrawVert, col) == 16,
+              "UIVertex::Pack expects the default ImDrawVert layout");
+
+namespace
+{
+	void PackScalar(const ImDrawVert& _src, UIPackedVertex& _dst)
+	{
+		const auto to_snorm = [](float _value)
+		{
+			return static_cast<int16_t>(std::clamp(std::lrint(_value * UIVertex::k_position_subpixels), -32767l, 32767l));
+		};
+
+		const auto to_unorm = [](float _value)
+		{
+			return static_cast<uint16_t>(std::clamp(std::lrint(_value * 65535.0f), 0l, 65535l));
+		};
+
+		_dst.pos[0] = to_snorm(_src.pos.x);
+		_dst.pos[1] = to_snorm(_src.pos.y);
+		_dst.uv[0]  = to_unorm(_src.uv.x);
+		_dst.uv[1]  = to_unorm(_src.uv.y);
+		_dst.col    = _src.col;
+	}
+}
+
+void UIVertex::Pack(const ImDrawVert* _src, UIPackedVertex* _dst, size_t _count)
+{
+	size_t i = 0;
+
+#ifdef UI_VERTEX_SSE2
+	// pos.xy and uv.xy are the first 16 bytes of ImDrawVert, so one load converts both.
+	// SSE2 has no unsigned 32 -> 16 saturating pack, the uv lanes are biased into signed
+	// range for _mm_packs_epi32 and flipped back afterwards
+	const __m128  scale = _mm_setr_ps(k_position_subpixels, k_position_subpixels, 65535.0f, 65535.0f);
+	const __m128i bias  = _mm_setr_epi32(0, 0, 32768, 32768);
+	const __m128i flip  = _mm_setr_epi16(0, 0, -32768, -32768, 0, 0, -32768, -32768);
+	const __m128i lo    = _mm_setr_epi32(-32767, -32767, -32768, -32768);
+
+	for ( ; i + 2 <= _count ; i += 2)
+	{
+		const __m128 a = _mm_loadu_ps(&_src[i].pos.x);
+		const __m128 b = _mm_loadu_ps(&_src[i + 1].pos.x);
+
+		__m128i ia = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(a, scale)), bias);
+		__m128i ib = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(b, scale)), bias);
+
+		// Keep -32768 out of the snorm lanes so both ends decode symmetrically
+		ia = _mm_or_si128(_mm_and_si128(_mm_cmpgt_epi32(ia, lo), ia), _mm_andnot_si128(_mm_cmpgt_epi32(ia, lo), lo));
+		ib = _mm_or_si128(_mm_and_si128(_mm_cmpgt_epi32(ib, lo), ib), _mm_andnot_si128(_mm_cmpgt_epi32(ib, lo), lo));
+
+		const __m128i packed = _mm_xor_si128(_mm_packs_epi32(ia, ib), flip);
+
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(&_dst[i]), packed);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(&_dst[i + 1]), _mm_srli_si128(packed, 8));
+		_dst[i].col     = _src[i].col;
+		_dst[i + 1].col = _src[i + 1].col;
+	}
+#endif
+
+	for ( ; i < _count ; ++i)
+	{
+		PackScalar(_src[i], _dst[i]);
+	}
+}
@@ -17,15 +17,30 @@ public:
 
 	void SetWindowTitle(std::string);
 
+	// Blocks until an event arrives, or at most _timeout seconds when it is positive
+	void WaitEvents(double _timeout = 0.0);
+
+	bool InputReceived();
+
+	// True once after the window was resized or needs repainting, the last presented image can no longer be trusted
+	bool RedrawRequested();
+
+	bool Minimised() const;
+
 private:
 
 	void UpdateWindowTitle();
 
 	static void WindowCloseCallback(GLFWwindow*);
 
+	static void WindowRefreshCallback(GLFWwindow*);
+
+	static void FramebufferSizeCallback(GLFWwindow*, int, int);
+
 	bool Input();
 
 	static bool m_force_close;
+	static bool m_redraw_requested;
 
 	InputManager m_input_manager;
 
@@ -7,12 +7,16 @@ namespace VkRes
 	public:
 		Buffer() = default;
 
-		Buffer(vk::Device _device, vk::PhysicalDevice _physical_device, vk::DeviceSize _size, vk::BufferUsageFlagBits _flag)
+		Buffer(vk::Device              _device,
+		       vk::PhysicalDevice      _physical_device,
+		       vk::DeviceSize          _size,
+		       vk::BufferUsageFlags    _flag,
+		       vk::MemoryPropertyFlags _properties = vk::MemoryPropertyFlagBits::eHostVisible)
 		{
 			const auto buffer_data = VkRes::CreateBuffer(_device,
 			                                             _physical_device, _size,
 			                                             _flag,
-			                                             vk::MemoryPropertyFlagBits::eHostVisible);
+			                                             _properties);
 
 			m_buffer = std::get<0>(buffer_data);
 			m_memory = std::get<1>(buffer_data);
@@ -68,6 +72,11 @@ namespace VkRes
 			return m_buffer;
 		}
 
+		[[nodiscard]] vk::DeviceMemory Memory() const
+		{
+			return m_memory;
+		}
+
 		void Flush(vk::Device _device) const
 		{
 			vk::MappedMemoryRange mapped_memory =
@@ -82,9 +91,9 @@ namespace VkRes
 		}
 
 	private:
-		void*            m_data;
-		vk::Buffer       m_buffer;
-		vk::DeviceMemory m_memory;
+		void*            m_data   = nullptr;
+		vk::Buffer       m_buffer = nullptr;
+		vk::DeviceMemory m_memory = nullptr;
 
 		bool m_has_mapped = false;
 	};
@@ -19,14 +19,16 @@ namespace VkRes
 			assert(("Failed to create command pool", result == vk::Result::eSuccess));
 		}
 
-		void CreateCmdBuffers(vk::Device _device, int _number_of_buffers)
+		void CreateCmdBuffers(vk::Device             _device,
+		                      int                    _number_of_buffers,
+		                      vk::CommandBufferLevel _level = vk::CommandBufferLevel::ePrimary)
 		{
 			m_command_buffers.resize(_number_of_buffers);
 
 			vk::CommandBufferAllocateInfo alloc_info =
 			{
 				CommandPool(),
-				vk::CommandBufferLevel::ePrimary,
+				_level,
 				m_command_buffers.size()
 			};
 
@@ -52,11 +54,21 @@ namespace VkRes
 			m_command_buffers[_command_buffer_index].beginRenderPass(_render_pass_begin_info, _contents);
 		}
 
+		void NextSubpass(vk::SubpassContents _contents, int _command_buffer_index)
+		{
+			m_command_buffers[_command_buffer_index].nextSubpass(_contents);
+		}
+
 		void EndRenderPass(int _command_buffer_index)
 		{
 			m_command_buffers[_command_buffer_index].endRenderPass();
 		}
 
+		void ExecuteCommands(const vk::CommandBuffer* _secondary_buffers, uint32_t _count, int _command_buffer_index)
+		{
+			m_command_buffers[_command_buffer_index].executeCommands(_count, _secondary_buffers);
+		}
+
 		void SetViewport(int _viewport, float _width, float _height, float minDepth, float maxDepth, int _command_buffer_index)
 		{
 			vk::Viewport viewport =
@@ -197,7 +209,13 @@ namespace VkRes
 
 		void FreeCommandBuffers(vk::Device _device)
 		{
+			if (m_command_buffers.empty())
+			{
+				return;
+			}
+
 			_device.freeCommandBuffers(m_command_pool, static_cast<uint32_t>(m_command_buffers.size()), m_command_buffers.data());
+			m_command_buffers.clear();
 		}
 
 		void Destroy(vk::Device _device)
@@ -0,0 +1,113 @@
+#pragma once
+
+namespace VkRes
+{
+	// Transient command pools, one per frame in flight and recording thread. Buffers are handed out from the
+	// pool of the frame being recorded and all of them are recycled by a single vkResetCommandPool once that
+	// frame's fence has signalled, nothing is reset or freed one buffer at a time.
+	// A pool is externally synchronised, so each recording thread uses its own
+	class FrameCommandPools
+	{
+	public:
+		FrameCommandPools() = default;
+
+		FrameCommandPools(vk::Device                _device,
+		                  VkGen::QueueFamilyIndices _queue_family_indices,
+		                  uint32_t                  _frame_count,
+		                  uint32_t                  _thread_count = 1)
+		{
+			m_thread_count = std::max(_thread_count, 1u);
+			m_pools.resize(_frame_count * m_thread_count);
+
+			const vk::CommandPoolCreateInfo create_info =
+			{
+				vk::CommandPoolCreateFlagBits::eTransient,
+				static_cast<uint32_t>(_queue_family_indices.graphics_family)
+			};
+
+			for (auto& pool : m_pools)
+			{
+				const auto result = _device.createCommandPool(&create_info, nullptr, &pool.pool);
+				assert(("Failed to create command pool", result == vk::Result::eSuccess));
+			}
+		}
+
+		void Destroy(vk::Device _device)
+		{
+			// Destroying a pool frees every buffer allocated from it
+			for (auto& pool : m_pools)
+			{
+				if (pool.pool != nullptr)
+				{
+					_device.destroyCommandPool(pool.pool);
+				}
+			}
+
+			m_pools.clear();
+		}
+
+		// Recycles every buffer the frame's threads allocated, only call once the frame's fence has signalled
+		void Reset(vk::Device _device, uint32_t _frame)
+		{
+			for (uint32_t thread = 0 ; thread < m_thread_count ; ++thread)
+			{
+				Pool& pool = m_pools[_frame * m_thread_count + thread];
+
+				if (pool.used[0] == 0 && pool.used[1] == 0)
+				{
+					continue;
+				}
+
+				_device.resetCommandPool(pool.pool, {});
+				pool.used[0] = 0;
+				pool.used[1] = 0;
+			}
+		}
+
+		// A buffer in the initial state, valid until the frame is reset. Buffers are only allocated the first time
+		// a frame needs more than before, afterwards the reset ones are handed out again
+		[[nodiscard]] vk::CommandBuffer Allocate(vk::Device             _device,
+		                                         uint32_t               _frame,
+		                                         uint32_t               _thread,
+		                                         vk::CommandBufferLevel _level = vk::CommandBufferLevel::ePrimary)
+		{
+			Pool&          pool    = m_pools[_frame * m_thread_count + _thread];
+			const uint32_t level   = _level == vk::CommandBufferLevel::ePrimary ? 0 : 1;
+			auto&          buffers = pool.buffers[level];
+
+			if (pool.used[level] == buffers.size())
+			{
+				const vk::CommandBufferAllocateInfo alloc_info =
+				{
+					pool.pool,
+					_level,
+					1
+				};
+
+				vk::CommandBuffer buffer;
+				const auto        result = _device.allocateCommandBuffers(&alloc_info, &buffer);
+				assert(("Failed to allocate command buffers", result == vk::Result::eSuccess));
+
+				buffers.push_back(buffer);
+			}
+
+			return buffers[pool.used[level]++];
+		}
+
+		[[nodiscard]] uint32_t ThreadCount() const
+		{
+			return m_thread_count;
+		}
+
+	private:
+		struct Pool
+		{
+			vk::CommandPool                pool = nullptr;
+			std::vector<vk::CommandBuffer> buffers[2]; // primary, secondary
+			uint32_t                       used[2] = {0, 0};
+		};
+
+		std::vector<Pool> m_pools; // frame major, _frame * m_thread_count + _thread
+		uint32_t          m_thread_count = 1;
+	};
+}
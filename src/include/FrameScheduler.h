@@ -0,0 +1,246 @@
+#pragma once
+
+#include "Fence.h"
+
+#include <deque>
+#include <functional>
+
+namespace VkRes
+{
+	// Orders the CPU against one queue with a single timeline semaphore. Every submit signals the next value, each
+	// frame slot remembers the value of its last submit and deferred deletions are tagged with the value they wait for,
+	// so every CPU wait becomes "wait for value N" and nothing has to be reset between frames.
+	// Without VK_KHR_timeline_semaphore it falls back to a fence per frame slot behind the same interface
+	class FrameScheduler
+	{
+	public:
+		FrameScheduler() = default;
+
+		FrameScheduler(vk::Device _device, uint32_t _frame_count, bool _timeline)
+		{
+			m_frame_values.assign(_frame_count, 0);
+
+			if (_timeline)
+			{
+				const vk::SemaphoreTypeCreateInfoKHR type_info =
+				{
+					vk::SemaphoreTypeKHR::eTimeline,
+					0
+				};
+
+				vk::SemaphoreCreateInfo create_info = {};
+				create_info.pNext                   = &type_info;
+
+				const auto result = _device.createSemaphore(&create_info, nullptr, &m_timeline);
+				assert(("Failed to create a timeline semaphore", result == vk::Result::eSuccess));
+
+				// Extension entry points are not exported by the loader
+				m_wait_semaphores   = reinterpret_cast<PFN_vkWaitSemaphoresKHR>(_device.getProcAddr("vkWaitSemaphoresKHR"));
+				m_get_counter_value = reinterpret_cast<PFN_vkGetSemaphoreCounterValueKHR>(
+					_device.getProcAddr("vkGetSemaphoreCounterValueKHR"));
+				assert(("Failed to load the timeline semaphore functions", m_wait_semaphores && m_get_counter_value));
+				return;
+			}
+
+			// Created signalled, a slot that was never submitted has nothing to wait for
+			m_fences.resize(_frame_count);
+			for (auto& fence : m_fences)
+			{
+				fence = Fence(_device, vk::FenceCreateFlagBits::eSignaled);
+			}
+		}
+
+		// Runs every outstanding deletion, only call once the device is idle
+		void Destroy(vk::Device _device)
+		{
+			for (auto& deletion : m_deferred)
+			{
+				deletion.release();
+			}
+			m_deferred.clear();
+
+			if (m_timeline != nullptr)
+			{
+				_device.destroySemaphore(m_timeline);
+				m_timeline = nullptr;
+			}
+
+			for (auto& fence : m_fences)
+			{
+				fence.Destroy(_device);
+			}
+			m_fences.clear();
+		}
+
+		// Submits to _queue on behalf of a frame slot, additionally signalling the next timeline value which is returned
+		uint64_t Submit(vk::Device _device, vk::Queue _queue, vk::SubmitInfo _submit_info, uint32_t _frame)
+		{
+			const uint64_t value = ++m_submitted;
+			m_frame_values[_frame] = value;
+
+			if (m_timeline == nullptr)
+			{
+				const vk::Fence fence = m_fences[_frame].FenceInstance();
+
+				const auto reset_result = _device.resetFences(1, &fence);
+				assert(("Failed to reset fence", reset_result == vk::Result::eSuccess));
+
+				const auto result = _queue.submit(1, &_submit_info, fence);
+				assert(("Failed to submit a draw queue", result == vk::Result::eSuccess));
+
+				return value;
+			}
+
+			// Binary semaphores ignore their value, it only has to be there to keep the arrays the same length
+			m_signal_semaphores.assign(_submit_info.pSignalSemaphores,
+			                           _submit_info.pSignalSemaphores + _submit_info.signalSemaphoreCount);
+			m_signal_semaphores.push_back(m_timeline);
+			m_signal_values.assign(m_signal_semaphores.size(), 0);
+			m_signal_values.back() = value;
+
+			const vk::TimelineSemaphoreSubmitInfoKHR timeline_info =
+			{
+				0,
+				nullptr,
+				static_cast<uint32_t>(m_signal_values.size()),
+				m_signal_values.data()
+			};
+
+			_submit_info.pNext                = &timeline_info;
+			_submit_info.signalSemaphoreCount = static_cast<uint32_t>(m_signal_semaphores.size());
+			_submit_info.pSignalSemaphores    = m_signal_semaphores.data();
+
+			const auto result = _queue.submit(1, &_submit_info, nullptr);
+			assert(("Failed to submit a draw queue", result == vk::Result::eSuccess));
+
+			return value;
+		}
+
+		// Blocks until the GPU has finished everything submitted up to and including _value
+		void Wait(vk::Device _device, uint64_t _value)
+		{
+			if (_value <= m_completed)
+			{
+				return;
+			}
+
+			assert(("Waiting for a value that was never submitted", _value <= m_submitted));
+
+			if (m_timeline != nullptr)
+			{
+				const vk::SemaphoreWaitInfoKHR wait_info =
+				{
+					{},
+					1,
+					&m_timeline,
+					&_value
+				};
+
+				const auto result = m_wait_semaphores(_device, reinterpret_cast<const VkSemaphoreWaitInfoKHR*>(&wait_info),
+				                                      std::numeric_limits<uint64_t>::max());
+				assert(("Failed to wait for the timeline semaphore", result == VK_SUCCESS));
+
+				m_completed = _value;
+				return;
+			}
+
+			// The queue runs submissions in order, so the earliest slot at or past _value covers it
+			uint32_t slot = 0;
+			for (uint32_t i = 0 ; i < m_frame_values.size() ; ++i)
+			{
+				if (m_frame_values[i] >= _value && (m_frame_values[slot] < _value || m_frame_values[i] < m_frame_values[slot]))
+				{
+					slot = i;
+				}
+			}
+
+			const vk::Fence fence  = m_fences[slot].FenceInstance();
+			const auto      result = _device.waitForFences(1, &fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+			assert(("Failed to wait for fence", result == vk::Result::eSuccess));
+
+			m_completed = m_frame_values[slot];
+		}
+
+		// Blocks until the slot's last submission has retired, after which everything it used can be reused
+		void WaitFrame(vk::Device _device, uint32_t _frame)
+		{
+			Wait(_device, m_frame_values[_frame]);
+		}
+
+		// Highest value the GPU is known to have finished, polled without blocking
+		uint64_t Completed(vk::Device _device)
+		{
+			if (m_timeline != nullptr)
+			{
+				uint64_t   value  = 0;
+				const auto result = m_get_counter_value(_device, m_timeline, &value);
+				assert(("Failed to read the timeline semaphore", result == VK_SUCCESS));
+
+				m_completed = std::max(m_completed, value);
+				return m_completed;
+			}
+
+			for (uint32_t i = 0 ; i < m_frame_values.size() ; ++i)
+			{
+				if (m_frame_values[i] > m_completed && _device.getFenceStatus(m_fences[i].FenceInstance()) == vk::Result::eSuccess)
+				{
+					m_completed = m_frame_values[i];
+				}
+			}
+
+			return m_completed;
+		}
+
+		// Runs _deletion once the next submit has retired, which covers a frame that is still being recorded
+		void Defer(std::function<void()> _deletion)
+		{
+			m_deferred.push_back({m_submitted + 1, std::move(_deletion)});
+		}
+
+		// Runs the deferred deletions the GPU is done with
+		void Collect(vk::Device _device)
+		{
+			if (m_deferred.empty())
+			{
+				return;
+			}
+
+			const uint64_t completed = Completed(_device);
+
+			while (!m_deferred.empty() && m_deferred.front().value <= completed)
+			{
+				m_deferred.front().release();
+				m_deferred.pop_front();
+			}
+		}
+
+		// Value the next submit will signal
+		[[nodiscard]] uint64_t NextValue() const
+		{
+			return m_submitted + 1;
+		}
+
+		[[nodiscard]] bool Timeline() const
+		{
+			return m_timeline != nullptr;
+		}
+
+	private:
+		struct Deletion
+		{
+			uint64_t              value;
+			std::function<void()> release;
+		};
+
+		vk::Semaphore                     m_timeline          = nullptr;
+		PFN_vkWaitSemaphoresKHR           m_wait_semaphores   = nullptr;
+		PFN_vkGetSemaphoreCounterValueKHR m_get_counter_value = nullptr;
+		std::vector<Fence>                m_fences;
+		std::vector<uint64_t>             m_frame_values;
+		uint64_t                          m_submitted = 0;
+		uint64_t                          m_completed = 0;
+		std::deque<Deletion>              m_deferred;
+		std::vector<vk::Semaphore>        m_signal_semaphores;
+		std::vector<uint64_t>             m_signal_values;
+	};
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "include\imgui-1.70\imgui.h"
+
+struct stbtt_fontinfo;
+
+// Rasterizes glyphs of a TTF font on first use instead of baking every range into the atlas up front.
+// Only the base ranges are baked by ImGui, the rest are packed into a region reserved in the same
+// atlas and handed back as dirty rectangles for the renderer to copy into the texture.
+// ImGui 1.70 has no hook for missing glyphs, so the text ImGui lays out each frame is captured through its text log
+// and anything new is rasterized before the next frame, drawn with the fallback glyph until then.
+class GlyphCache
+{
+public:
+	struct Rect
+	{
+		uint32_t x;
+		uint32_t y;
+		uint32_t width;
+		uint32_t height;
+	};
+
+	GlyphCache();
+
+	~GlyphCache();
+
+	// Returns false if the font file could not be read, the cache then stays disabled.
+	// The reserved region is sized to hold _glyph_budget glyphs at _size_pixels
+	bool Load(const std::string& _file, float _size_pixels, uint32_t _glyph_budget = k_default_glyph_budget);
+
+	// Rasterize signed distance fields instead of coverage. A distance field font is built at k_distance_field_scale
+	// times the loaded size and drawn scaled down, so text can be zoomed without rebuilding the atlas.
+	// Takes effect on the next AddToAtlas
+	void SetDistanceField(bool _enabled)
+	{
+		m_distance_field = _enabled;
+	}
+
+	// Adds the font with _base_ranges baked and reserves the cache region, call before the atlas is built.
+	// _bytes_per_pixel follows the atlas texture, 4 for RGBA32 and 1 for Alpha8
+	void AddToAtlas(ImFontAtlas* _atlas, const ImWchar* _base_ranges, uint32_t _bytes_per_pixel);
+
+	// Picks up where the atlas builder placed the reserved region
+	void OnAtlasBuilt(ImFontAtlas* _atlas);
+
+	// Codepoints the font already has or the font file lacks are ignored
+	void Request(ImWchar _codepoint);
+
+	void Request(const char* _text, const char* _text_end = nullptr);
+
+	// Records the text laid out between the two calls, BeginCapture after ImGui::NewFrame and EndCapture before
+	// ImGui::Render. A log the application starts in between ends the capture early
+	void BeginCapture();
+
+	void EndCapture();
+
+	// Rasterizes everything requested since the last call, returns true if glyphs were added to the font
+	bool Update();
+
+	// Queues the whole used region again, for when a previous upload may never have reached the GPU
+	void MarkAllDirty();
+
+	void ClearDirty()
+	{
+		m_dirty.clear();
+	}
+
+	[[nodiscard]] bool Loaded() const
+	{
+		return !m_font_data.empty();
+	}
+
+	[[nodiscard]] bool Enabled() const
+	{
+		return m_font != nullptr;
+	}
+
+	// Dirty rectangles relative to the region origin, Pixels() holds the whole region with a row pitch of RegionSize()
+	[[nodiscard]] const std::vector<Rect>& Dirty() const
+	{
+		return m_dirty;
+	}
+
+	[[nodiscard]] const uint8_t* Pixels() const
+	{
+		return m_pixels.data();
+	}
+
+	[[nodiscard]] uint32_t RegionX() const
+	{
+		return m_region_x;
+	}
+
+	[[nodiscard]] uint32_t RegionY() const
+	{
+		return m_region_y;
+	}
+
+	[[nodiscard]] uint32_t RegionSize() const
+	{
+		return m_region_size;
+	}
+
+	[[nodiscard]] uint32_t BytesPerPixel() const
+	{
+		return m_bytes_per_pixel;
+	}
+
+	[[nodiscard]] uint32_t GlyphCount() const
+	{
+		return m_glyph_count;
+	}
+
+	[[nodiscard]] bool Full() const
+	{
+		return m_full;
+	}
+
+	[[nodiscard]] bool DistanceField() const
+	{
+		return m_distance_field;
+	}
+
+	static constexpr float    k_distance_field_scale = 2.0f;
+	static constexpr uint32_t k_default_glyph_budget = 512;
+
+private:
+	static constexpr uint32_t k_padding         = 1;
+	static constexpr uint32_t k_rect_id         = 0x10000;
+	static constexpr uint32_t k_min_region_size = 256;
+
+	// Distances reach k_field_padding pixels outside the outline, the outline itself is stored as k_field_edge
+	static constexpr int     k_field_padding = 4;
+	static constexpr uint8_t k_field_edge    = 128;
+
+	bool Rasterize(ImWchar _codepoint);
+
+	bool Allocate(uint32_t _width, uint32_t _height, uint32_t& _x, uint32_t& _y);
+
+	void AddDirty(const Rect& _rect);
+
+	std::vector<unsigned char>      m_font_data;
+	std::unique_ptr<stbtt_fontinfo> m_info;
+	ImFont*                         m_font            = nullptr;
+	float                           m_size_pixels     = 0.0f;
+	float                           m_scale           = 0.0f;
+	uint32_t                        m_bytes_per_pixel = 4;
+	int                             m_rect_index      = -1;
+	float                           m_offset_y        = 0.0f;
+	bool                            m_distance_field  = false;
+	uint32_t                        m_glyph_budget    = k_default_glyph_budget;
+	bool                            m_capturing       = false;
+	int                             m_log_depth       = 0;
+
+	uint32_t             m_atlas_width  = 1;
+	uint32_t             m_atlas_height = 1;
+	uint32_t             m_region_x     = 0;
+	uint32_t             m_region_y     = 0;
+	uint32_t             m_region_size  = k_min_region_size;
+	std::vector<uint8_t> m_pixels;
+	std::vector<uint8_t> m_scratch;
+
+	// Shelf packer state, glyphs are placed left to right in rows of the tallest glyph so far
+	uint32_t m_shelf_x      = 0;
+	uint32_t m_shelf_y      = 0;
+	uint32_t m_shelf_height = 0;
+	bool     m_full         = false;
+
+	std::vector<ImWchar>        m_requested;
+	std::vector<ImWchar>        m_cached;
+	std::unordered_set<ImWchar> m_missing;
+	std::vector<Rect>           m_dirty;
+	uint32_t                    m_glyph_count = 0;
+};
@@ -160,6 +160,18 @@ namespace VkRes
 			has_set_rasterizer = true;
 		}
 
+		// Replaces the straight alpha blend set by SetRasterizer, call after it
+		void SetBlend(vk::BlendFactor _src_colour,
+		              vk::BlendFactor _dst_colour,
+		              vk::BlendFactor _src_alpha,
+		              vk::BlendFactor _dst_alpha)
+		{
+			m_colour_blend_attachement.setSrcColorBlendFactor(_src_colour);
+			m_colour_blend_attachement.setDstColorBlendFactor(_dst_colour);
+			m_colour_blend_attachement.setSrcAlphaBlendFactor(_src_alpha);
+			m_colour_blend_attachement.setDstAlphaBlendFactor(_dst_alpha);
+		}
+
 		void SetPushConstants(uint32_t _offset, uint32_t _size, vk::ShaderStageFlagBits _stage)
 		{
 			m_push_constant = vk::PushConstantRange
@@ -210,7 +222,7 @@ namespace VkRes
 			has_set_pipline_layout = true;
 		}
 
-		void CreateGraphicPipeline(vk::Device _device, vk::RenderPass _render_pass)
+		void CreateGraphicPipeline(vk::Device _device, vk::RenderPass _render_pass, uint32_t _subpass = 0)
 		{
 			if (!LogAndCheckConstructionState())
 			{
@@ -242,7 +254,7 @@ namespace VkRes
 				&dynamic_state,
 				m_layout,
 				_render_pass,
-				0,
+				_subpass,
 				nullptr,
 				0
 			};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+// Non-cryptographic 64 bit hash used to detect unchanged UI geometry between frames.
+// Bulk data is consumed in 32 byte stripes by four independent accumulators (xxHash64 style),
+// so there is no dependency chain between lanes and the loop runs close to memory bandwidth.
+namespace Hash
+{
+	constexpr uint64_t k_prime_1 = 0x9E3779B185EBCA87ull;
+	constexpr uint64_t k_prime_2 = 0xC2B2AE3D27D4EB4Full;
+	constexpr uint64_t k_prime_3 = 0x165667B19E3779F9ull;
+	constexpr uint64_t k_prime_4 = 0x85EBCA77C2B2AE63ull;
+	constexpr uint64_t k_prime_5 = 0x27D4EB2F165667C5ull;
+
+	inline uint64_t Rotl(uint64_t _value, int _bits)
+	{
+		return (_value << _bits) | (_value >> (64 - _bits));
+	}
+
+	inline uint64_t Read64(const uint8_t* _ptr)
+	{
+		uint64_t value;
+		std::memcpy(&value, _ptr, sizeof(value));
+		return value;
+	}
+
+	inline uint64_t Round(uint64_t _acc, uint64_t _input)
+	{
+		_acc += _input * k_prime_2;
+		_acc = Rotl(_acc, 31);
+		return _acc * k_prime_1;
+	}
+
+	inline uint64_t MergeRound(uint64_t _acc, uint64_t _value)
+	{
+		_acc ^= Round(0, _value);
+		return _acc * k_prime_1 + k_prime_4;
+	}
+
+	inline uint64_t Avalanche(uint64_t _hash)
+	{
+		_hash ^= _hash >> 33;
+		_hash *= k_prime_2;
+		_hash ^= _hash >> 29;
+		_hash *= k_prime_3;
+		_hash ^= _hash >> 32;
+		return _hash;
+	}
+
+	inline uint64_t Bytes(const void* _data, size_t _size, uint64_t _seed = 0)
+	{
+		const uint8_t* ptr = static_cast<const uint8_t*>(_data);
+		const uint8_t* end = ptr + _size;
+		uint64_t       hash;
+
+		if (_size >= 32)
+		{
+			uint64_t lanes[4] =
+			{
+				_seed + k_prime_1 + k_prime_2,
+				_seed + k_prime_2,
+				_seed,
+				_seed - k_prime_1
+			};
+
+			const uint8_t* const limit = end - 32;
+			do
+			{
+				for (int lane = 0 ; lane < 4 ; ++lane)
+				{
+					lanes[lane] = Round(lanes[lane], Read64(ptr + lane * 8));
+				}
+				ptr += 32;
+			}
+			while (ptr <= limit);
+
+			hash = Rotl(lanes[0], 1) + Rotl(lanes[1], 7) + Rotl(lanes[2], 12) + Rotl(lanes[3], 18);
+			for (uint64_t lane : lanes)
+			{
+				hash = MergeRound(hash, lane);
+			}
+		}
+		else
+		{
+			hash = _seed + k_prime_5;
+		}
+
+		hash += static_cast<uint64_t>(_size);
+
+		for ( ; ptr + 8 <= end ; ptr += 8)
+		{
+			hash ^= Round(0, Read64(ptr));
+			hash = Rotl(hash, 27) * k_prime_1 + k_prime_4;
+		}
+
+		for ( ; ptr < end ; ++ptr)
+		{
+			hash ^= (*ptr) * k_prime_5;
+			hash = Rotl(hash, 11) * k_prime_1;
+		}
+
+		return Avalanche(hash);
+	}
+
+	template <typename T> uint64_t Value(const T& _value, uint64_t _seed = 0)
+	{
+		return Bytes(&_value, sizeof(T), _seed);
+	}
+
+	inline uint64_t Combine(uint64_t _seed, uint64_t _hash)
+	{
+		return Avalanche(_seed ^ (_hash + k_prime_3 + Rotl(_seed, 17)));
+	}
+}
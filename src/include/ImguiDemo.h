@@ -4,6 +4,11 @@
 #include "Settings.h"
 #include "UI.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 class VkImguiDemo : public VkDemo
 {
 public:
@@ -30,6 +35,10 @@ public:
 
 	void Shutdown() override;
 
+	// Font for the dynamic glyph mode, call before Setup. Logs a warning and leaves the mode off if it cannot be read
+	void SetFontFile(const std::string& _file, float _size_pixels,
+	                 uint32_t _glyph_budget = GlyphCache::k_default_glyph_budget);
+
 	static VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT      _message_severity,
 	                                                    VkDebugUtilsMessageTypeFlagsEXT             _message_type,
 	                                                    const VkDebugUtilsMessengerCallbackDataEXT* _p_callback_data,
@@ -37,6 +46,9 @@ public:
 
 private:
 
+	// Waits for the current frame slot and acquires the image it renders to, false if the frame has to be skipped
+	bool AcquireNextImage();
+
 	void SubmitQueue() override;
 
 	void CreateSyncObjects() override;
@@ -63,24 +75,114 @@ private:
 
 	void RecreateSwapchain() override;
 
+	// Copies the MSAA settings every swapchain build uses. Main thread only, with the render thread stopped
+	void CaptureRenderSettings();
+
+	// Resize path, rebuilds the swapchain from the old one along with the colour target and framebuffers. The render
+	// pass and pipelines are kept, the retired resources go away once the frames using them have finished.
+	// Call after RefreshSwapchainDetails, only while the surface format is unchanged
+	void ResizeSwapchain();
+
 	void CreateCmdBuffers() override;
 
+	void CreateSecondaryCmdBuffers();
+
+	void RecordSceneCmdBuffer(int);
+
+	void RecordScene(vk::CommandBuffer);
+
+	// The render thread owns the device from Start until Stop, the main thread only touches Vulkan in between
+	void StartRenderThread();
+
+	void StopRenderThread();
+
+	// Takes every snapshot the main thread publishes and runs its frame graph
+	void RenderLoop();
+
+	// Render thread, queues acquire, update, recording and submit of the taken snapshot on the job system
+	void LaunchFrameGraph();
+
+	// Uploads the UI for the acquired frame and sizes the parallel recording
+	void UpdateFrame();
+
+	// One of the parallel recording tasks, the scene for task 0 and a UI chunk for the others
+	void RecordSecondaryCmdBuffer(uint32_t);
+
+	void RecordUICmdBuffer(int);
+
+	void InvalidateSecondaryCmdBuffers();
+
 	VkRes::Swapchain                m_swapchain;
 	VkRes::Command                  m_command;
+	VkRes::FrameCommandPools        m_frame_pools;
+	VkRes::Command                  m_scene_command;
+	VkRes::Command                  m_ui_command;
 	VkRes::RenderTarget             m_backbuffer;
 	VkRes::RenderPass               m_render_pass;
 	std::vector<VkRes::FrameBuffer> m_framebuffers;
 	VkRes::GraphicsPipeline         m_graphics_pipeline;
 	VkRes::Shader                   m_vert;
 	VkRes::Shader                   m_frag;
-	std::vector<VkRes::Fence>       m_inflight_fences;
+	VkRes::FrameScheduler           m_scheduler;
 	std::vector<VkRes::Semaphore>   m_image_available_semaphores;
 	std::vector<VkRes::Semaphore>   m_render_finished_semaphores;
 
 	UI m_ui_instance;
 
+	// With MSAA the UI gets its own single sampled subpass after the resolve
+	uint32_t m_ui_subpass = 0;
+
+	// MSAA the render pass was built with. The render thread resizes from these, never from Settings, which the
+	// main thread's UI may already have changed for the next rebuild
+	bool                    m_msaa         = false;
+	vk::SampleCountFlagBits m_sample_count = vk::SampleCountFlagBits::e1;
+
+	// Swapchain image acquired for the frame being recorded and the primary recorded for it
+	uint32_t          m_image_index = 0;
+	vk::CommandBuffer m_primary;
+
+	// Secondaries the primary executes, the scene's first. Parallel recording allocates them from m_frame_pools
+	std::vector<vk::CommandBuffer> m_secondary_buffers;
+	uint32_t                       m_ui_chunks = 0;
+
+	// Frame graph state, the frame in flight only reads settings copied before its launch
+	std::unique_ptr<JobSystem> m_jobs;
+	bool                       m_frame_skipped           = false;
+	bool                       m_recreate_pending        = false;
+	bool                       m_use_parallel_recording  = false;
+	bool                       m_use_incremental_present = false;
+
+	// Render thread hand off, m_render_mutex guards the flags and the settings published with each snapshot
+	std::thread             m_render_thread;
+	std::mutex              m_render_mutex;
+	std::condition_variable m_render_wake;
+	bool                    m_render_stop              = false;
+	bool                    m_frame_published          = false;
+	bool                    m_next_parallel_recording  = false;
+	bool                    m_next_incremental_present = false;
+
+	// Set by the render thread when the image on screen can no longer be trusted, read by the idle mode
+	std::atomic<bool> m_redraw_needed = false;
+
+	// Set by the render thread when the surface format changed. The render pass and the UI's pipeline then need the
+	// main thread's full rebuild
+	std::atomic<bool> m_rebuild_needed = false;
+
+	// Secondary buffers are only re-recorded when what they draw changes, one per frame slot so a slot can be
+	// re-recorded while the others are still in flight
+	std::vector<bool>     m_scene_recorded;
+	std::vector<uint64_t> m_ui_recorded_hashes;
+
 	float m_total_time;
 	float m_frame_delta;
 
 	bool m_settings_updated = false;
+
+	// Idle mode state, what the last presented frame showed and how long input has been quiet
+	uint64_t m_presented_hash = 0;
+	uint32_t m_quiet_frames   = 0;
+
+	// Incremental present, a new swapchain has nothing to be incremental against so its first present is whole
+	bool m_incremental_present = false;
+	bool m_full_present        = true;
 };
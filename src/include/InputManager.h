@@ -116,4 +116,7 @@ public:
 	bool KeyHit(EKeyCodes _keyCode);
 
 	bool KeyHeld(EKeyCodes _key_code);
+
+	// True if any key, mouse or text input arrived since the last call
+	bool ConsumeInputReceived();
 };
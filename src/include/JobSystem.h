@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work stealing task scheduler for one graph of tasks at a time. Each worker owns a deque, runs its own tasks newest
+// first and steals the oldest task of another worker once it runs dry. A finished task queues the dependents it
+// unblocked on its own deque, so a chain of stages tends to stay on one core.
+// The graph is built and waited for by a single owning thread, which joins in on the work while it waits
+class JobSystem
+{
+public:
+	using TaskId = uint32_t;
+
+	// When a task ran, in milliseconds since the graph was launched
+	struct Timing
+	{
+		const char* name;
+		uint32_t    thread; // worker index, WorkerCount() for the owning thread
+		double      begin;
+		double      end;
+	};
+
+	explicit JobSystem(uint32_t _worker_count);
+
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// Adds a task to the next graph, only once the previous one completed. The name has to outlive the graph
+	TaskId Add(const char*, std::function<void()>);
+
+	// The first task only becomes runnable once the second one finished
+	void Depend(TaskId, TaskId);
+
+	// Queues every task without dependencies, Add and Depend are invalid until the graph completed
+	void Launch();
+
+	// Runs tasks until the given one finished
+	void Wait(TaskId);
+
+	// Runs tasks until the whole graph finished, then publishes its timings
+	void WaitAll();
+
+	[[nodiscard]] bool Running() const
+	{
+		return m_remaining.load(std::memory_order_acquire) != 0;
+	}
+
+	// Tasks of the last completed graph, in launch order
+	[[nodiscard]] const std::vector<Timing>& Timings() const
+	{
+		return m_timings;
+	}
+
+	[[nodiscard]] uint32_t WorkerCount() const
+	{
+		return static_cast<uint32_t>(m_workers.size());
+	}
+
+	// Leaves one core for the owning thread
+	static uint32_t DefaultWorkerCount(uint32_t _max = 7);
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct Task
+	{
+		std::function<void()> func;
+		std::vector<TaskId>   dependents;
+		std::atomic<uint32_t> pending = 0;
+		std::atomic<bool>     done    = false;
+		Timing                timing  = {};
+	};
+
+	// Front is the oldest task, the owner pops from the back and thieves take from the front
+	struct Queue
+	{
+		std::mutex         mutex;
+		std::deque<TaskId> tasks;
+	};
+
+	void WorkerLoop(uint32_t);
+
+	void Push(uint32_t, TaskId);
+
+	bool Pop(uint32_t, TaskId&);
+
+	bool Steal(uint32_t, TaskId&);
+
+	// Pops or steals one task and runs it, false if there was nothing to run
+	bool RunOne(uint32_t);
+
+	void Execute(uint32_t, TaskId);
+
+	[[nodiscard]] double Elapsed() const;
+
+	std::vector<std::thread>            m_workers;
+	std::vector<std::unique_ptr<Queue>> m_queues; // one per worker, the owning thread's last
+	std::vector<std::unique_ptr<Task>>  m_tasks;
+	std::vector<TaskId>                 m_roots;
+	std::atomic<uint32_t>               m_remaining = 0;
+	std::atomic<uint32_t>               m_queued    = 0;
+	std::mutex                          m_sleep_mutex;
+	std::condition_variable             m_wake;
+	bool                                m_stop     = false;
+	bool                                m_launched = false;
+	Clock::time_point                   m_launch_time;
+	std::vector<Timing>                 m_timings;
+};
@@ -7,54 +7,59 @@ namespace VkRes
 	public:
 		RenderPass() = default;
 
-		RenderPass(std::vector<vk::AttachmentDescription>& _attachments,
-		           vk::AttachmentReference* const          _colour_attachements,
-		           const uint32_t                          _colour_attachment_count,
-		           vk::AttachmentReference* const          _depth_attachement,
-		           vk::AttachmentReference* const          _resolve_attachments,
-		           const uint32_t                          _resolve_attachment_count,
-		           const vk::PipelineBindPoint             _bind_point,
-		           vk::Device                              _device)
+		RenderPass(std::vector<vk::AttachmentDescription>&   _attachments,
+		           vk::AttachmentReference* const            _colour_attachements,
+		           const uint32_t                            _colour_attachment_count,
+		           vk::AttachmentReference* const            _depth_attachement,
+		           vk::AttachmentReference* const            _resolve_attachments,
+		           const uint32_t                            _resolve_attachment_count,
+		           const vk::PipelineBindPoint               _bind_point,
+		           vk::Device                                _device,
+		           const std::vector<vk::SubpassDependency>& _dependencies = {})
 		{
-			m_subpass_desc = vk::SubpassDescription
+			m_subpass_descs =
 			{
-				{},
-				_bind_point,
-				0,
-				nullptr,
-				_colour_attachment_count,
-				_colour_attachements,
-				_resolve_attachments,
-				_depth_attachement,
-				0,
-				nullptr
+				{
+					{},
+					_bind_point,
+					0,
+					nullptr,
+					_colour_attachment_count,
+					_colour_attachements,
+					_resolve_attachments,
+					_depth_attachement,
+					0,
+					nullptr
+				}
 			};
 
-			m_subpass_dependency = vk::SubpassDependency
+			// Without explicit dependencies the pass only waits for earlier colour output
+			m_subpass_dependencies = _dependencies;
+			if (m_subpass_dependencies.empty())
 			{
-				VK_SUBPASS_EXTERNAL,
-				0,
-				vk::PipelineStageFlagBits::eColorAttachmentOutput,
-				vk::PipelineStageFlagBits::eColorAttachmentOutput,
-				{},
-				vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite,
-				{}
-			};
+				m_subpass_dependencies.emplace_back(VK_SUBPASS_EXTERNAL,
+				                                    0,
+				                                    vk::PipelineStageFlagBits::eColorAttachmentOutput,
+				                                    vk::PipelineStageFlagBits::eColorAttachmentOutput,
+				                                    vk::AccessFlags{},
+				                                    vk::AccessFlagBits::eColorAttachmentRead |
+				                                    vk::AccessFlagBits::eColorAttachmentWrite,
+				                                    vk::DependencyFlags{});
+			}
 
-			m_pass_info = vk::RenderPassCreateInfo
-			{
-				{},
-				_attachments.size(),
-				_attachments.data(),
-				1,
-				&m_subpass_desc,
-				1,
-				&m_subpass_dependency
-			};
+			Create(_attachments, _device);
+		}
 
-			const auto result = _device.createRenderPass(&m_pass_info, nullptr, &m_render_pass);
+		// Several subpasses, the attachment references they point to only need to live until this returns
+		RenderPass(std::vector<vk::AttachmentDescription>&    _attachments,
+		           const std::vector<vk::SubpassDescription>& _subpasses,
+		           const std::vector<vk::SubpassDependency>&  _dependencies,
+		           vk::Device                                 _device)
+		{
+			m_subpass_descs        = _subpasses;
+			m_subpass_dependencies = _dependencies;
 
-			assert(("Failed to create render pass", result == vk::Result::eSuccess));
+			Create(_attachments, _device);
 		}
 
 		void Destroy(vk::Device _device)
@@ -73,10 +78,33 @@ namespace VkRes
 			return m_render_pass;
 		}
 
+		[[nodiscard]] uint32_t SubpassCount() const
+		{
+			return static_cast<uint32_t>(m_subpass_descs.size());
+		}
+
 	private:
-		vk::SubpassDescription   m_subpass_desc;
-		vk::SubpassDependency    m_subpass_dependency;
-		vk::RenderPassCreateInfo m_pass_info;
-		vk::RenderPass           m_render_pass = nullptr;
+		void Create(std::vector<vk::AttachmentDescription>& _attachments, vk::Device _device)
+		{
+			m_pass_info = vk::RenderPassCreateInfo
+			{
+				{},
+				_attachments.size(),
+				_attachments.data(),
+				static_cast<uint32_t>(m_subpass_descs.size()),
+				m_subpass_descs.data(),
+				static_cast<uint32_t>(m_subpass_dependencies.size()),
+				m_subpass_dependencies.data()
+			};
+
+			const auto result = _device.createRenderPass(&m_pass_info, nullptr, &m_render_pass);
+
+			assert(("Failed to create render pass", result == vk::Result::eSuccess));
+		}
+
+		std::vector<vk::SubpassDescription> m_subpass_descs;
+		std::vector<vk::SubpassDependency>  m_subpass_dependencies;
+		vk::RenderPassCreateInfo            m_pass_info;
+		vk::RenderPass                      m_render_pass = nullptr;
 	};
 }
\ No newline at end of file
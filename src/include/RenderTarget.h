@@ -24,7 +24,8 @@ namespace VkRes
 		             vk::MemoryPropertyFlagBits _properties,
 		             vk::ImageLayout            _finalLayout,
 		             VkRes::Command             _cmd,
-		             vk::Queue                  _queue)
+		             vk::Queue                  _queue,
+		             vk::ImageLayout            _initial_layout = vk::ImageLayout::eColorAttachmentOptimal)
 		{
 			auto image_data = VkRes::CreateImage(_device, _physical_device, _width, _height,
 			                                     _format, 1, _sample_count, _image_tiling,
@@ -34,9 +35,13 @@ namespace VkRes
 			m_image_memory = std::get<1>(image_data);
 			m_image_view   = VkRes::CreateImageView(_device, m_image, _format, vk::ImageAspectFlagBits::eColor, 1);
 
-			VkRes::TransitionImageLayout(_device, _cmd, _queue,
-			                             m_image, _format, vk::ImageLayout::eUndefined,
-			                             vk::ImageLayout::eColorAttachmentOptimal, 1u);
+			// eUndefined leaves the image to a render pass that starts from an undefined layout, which saves a queue wait
+			if (_initial_layout != vk::ImageLayout::eUndefined)
+			{
+				VkRes::TransitionImageLayout(_device, _cmd, _queue,
+				                             m_image, _format, vk::ImageLayout::eUndefined,
+				                             _initial_layout, 1u);
+			}
 
 			CreateAttachmentDesc(_format, _sample_count, _finalLayout);
 
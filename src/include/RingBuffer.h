@@ -0,0 +1,143 @@
+#pragma once
+
+#include "Buffer.h"
+
+namespace VkRes
+{
+	// One persistently mapped buffer per frame in flight. A frame only ever writes to its own
+	// slot, so the CPU can fill frame N while the GPU is still reading frame N - 1.
+	// Slots grow geometrically and are never released until Destroy().
+	// Without eHostVisible the slots are left unmapped and only filled by transfers.
+	class RingBuffer
+	{
+	public:
+		struct Range
+		{
+			vk::DeviceSize offset;
+			vk::DeviceSize size;
+		};
+
+		RingBuffer() = default;
+
+		RingBuffer(uint32_t                _frame_count,
+		           vk::BufferUsageFlags    _usage,
+		           vk::DeviceSize          _non_coherent_atom_size,
+		           vk::DeviceSize          _min_capacity = 64 * 1024,
+		           vk::MemoryPropertyFlags _properties   = vk::MemoryPropertyFlagBits::eHostVisible)
+		{
+			m_usage        = _usage;
+			m_properties   = _properties;
+			m_atom_size    = std::max<vk::DeviceSize>(_non_coherent_atom_size, 1);
+			m_min_capacity = _min_capacity;
+			m_slots.resize(_frame_count);
+		}
+
+		void Destroy(vk::Device _device)
+		{
+			for (auto& slot : m_slots)
+			{
+				slot.buffer.Destroy(_device);
+				slot.capacity = 0;
+			}
+		}
+
+		// Returns true if the slot had to be reallocated, in which case its previous contents are gone
+		bool Reserve(vk::Device _device, vk::PhysicalDevice _physical_device, uint32_t _frame, vk::DeviceSize _size)
+		{
+			Slot& slot = m_slots[_frame];
+
+			if (slot.buffer.HasBufferData() && _size <= slot.capacity)
+			{
+				return false;
+			}
+
+			vk::DeviceSize capacity = std::max(slot.capacity, m_min_capacity);
+			while (capacity < _size)
+			{
+				capacity *= 2;
+			}
+
+			slot.buffer.Destroy(_device);
+			slot.buffer = Buffer(_device, _physical_device, capacity, m_usage, m_properties);
+			if (m_properties & vk::MemoryPropertyFlagBits::eHostVisible)
+			{
+				slot.buffer.Map(_device);
+			}
+			slot.capacity = capacity;
+			++slot.generation;
+
+			return true;
+		}
+
+		void Flush(vk::Device _device, uint32_t _frame) const
+		{
+			m_slots[_frame].buffer.Flush(_device);
+		}
+
+		// Flushes only the written ranges, widened to nonCoherentAtomSize as the spec requires
+		void Flush(vk::Device _device, uint32_t _frame, const std::vector<Range>& _ranges) const
+		{
+			if (_ranges.empty())
+			{
+				return;
+			}
+
+			const Slot&                        slot = m_slots[_frame];
+			std::vector<vk::MappedMemoryRange> mapped_ranges;
+			mapped_ranges.reserve(_ranges.size());
+
+			for (const auto& range : _ranges)
+			{
+				const vk::DeviceSize begin = range.offset / m_atom_size * m_atom_size;
+				const vk::DeviceSize end   = std::min((range.offset + range.size + m_atom_size - 1) / m_atom_size * m_atom_size,
+				                                      slot.capacity);
+
+				mapped_ranges.emplace_back(slot.buffer.Memory(), begin, end - begin);
+			}
+
+			const auto flush_result = _device.flushMappedMemoryRanges(static_cast<uint32_t>(mapped_ranges.size()),
+			                                                          mapped_ranges.data());
+			assert(("Failed to flush mapped memory", flush_result == vk::Result::eSuccess));
+		}
+
+		[[nodiscard]] void* Data(uint32_t _frame) const
+		{
+			return m_slots[_frame].buffer.Data();
+		}
+
+		[[nodiscard]] vk::Buffer BufferData(uint32_t _frame) const
+		{
+			return m_slots[_frame].buffer.BufferData();
+		}
+
+		[[nodiscard]] vk::DeviceSize Capacity(uint32_t _frame) const
+		{
+			return m_slots[_frame].capacity;
+		}
+
+		// Bumped on every reallocation, anything recorded against the old buffer is stale
+		[[nodiscard]] uint32_t Generation(uint32_t _frame) const
+		{
+			return m_slots[_frame].generation;
+		}
+
+		[[nodiscard]] uint32_t FrameCount() const
+		{
+			return static_cast<uint32_t>(m_slots.size());
+		}
+
+	private:
+		struct Slot
+		{
+			Buffer         buffer;
+			vk::DeviceSize capacity   = 0;
+			uint32_t       generation = 0;
+		};
+
+		std::vector<Slot>       m_slots;
+		vk::BufferUsageFlags    m_usage;
+		vk::MemoryPropertyFlags m_properties   = vk::MemoryPropertyFlagBits::eHostVisible;
+		vk::DeviceSize          m_atom_size    = 1;
+		vk::DeviceSize          m_min_capacity = 0;
+	};
+}
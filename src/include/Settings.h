@@ -22,12 +22,60 @@ public:
 	// Sets multi-sampling anti aliasing sample count
 	void SetSampleCount(int);
 
+	// Sets drawing the whole UI with a single indirect draw
+	void SetIndirectDraw(bool);
+
+	// Sets uploading UI geometry in the 12 byte packed vertex format
+	void SetPackedVertices(bool);
+
+	// Sets spreading UI uploads across worker threads, applied per frame without a rebuild
+	void SetParallelUpload(bool);
+
+	// Sets drawing UI geometry from device local buffers filled through staging copies
+	void SetStagedUpload(bool);
+
+	// Sets binding all UI textures at once through descriptor indexing
+	void SetBindlessTextures(bool);
+
+	// Sets rasterizing glyphs outside the baked ranges on first use
+	void SetDynamicGlyphs(bool);
+
+	// Sets keeping the UI font atlas as single channel coverage
+	void SetAlphaAtlas(bool);
+
+	// Sets drawing UI text from a signed distance field atlas
+	void SetSdfText(bool);
+
+	// Sets drawing the UI into a cached layer that is only redrawn where it changed
+	void SetCachedLayer(bool);
+
+	// Sets skipping frames whose UI is unchanged and sleeping while there is no input, applied without a rebuild
+	void SetIdleMode(bool);
+
+	// Sets passing the damaged rect to vkQueuePresentKHR when VK_KHR_incremental_present is available, applied without a rebuild
+	void SetIncrementalPresent(bool);
+
+	// Sets recording the scene and chunks of the UI into secondaries on worker threads every frame, applied without a rebuild
+	void SetParallelRecording(bool);
+
 	vk::SampleCountFlagBits GetSampleCount() const;
 
 	bool Updated(bool);
 
-	bool use_msaa     = false;
-	int  sample_level = 2;
+	bool use_msaa             = false;
+	int  sample_level         = 2;
+	bool ui_indirect_draw     = false;
+	bool ui_packed_vertices   = false;
+	bool ui_parallel_upload   = false;
+	bool ui_staged_upload     = false;
+	bool ui_bindless_textures = false;
+	bool ui_dynamic_glyphs    = false;
+	bool ui_alpha_atlas       = false;
+	bool ui_sdf_text          = false;
+	bool ui_cached_layer      = false;
+	bool idle_mode            = false;
+	bool incremental_present  = false;
+	bool parallel_recording   = false;
 
 private:
 	static std::unique_ptr<Settings> m_instance;
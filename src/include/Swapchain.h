@@ -15,9 +15,10 @@ namespace VkRes
 
 		Swapchain() = default;
 
+		// Passing the swapchain being replaced retires it, images it already handed out stay valid until it is destroyed
 		Swapchain(vk::PhysicalDevice        _physical_device, vk::Device             _device,
 		          vk::SurfaceKHR&           _surface, VkGen::SwapChainSupportDetails _details,
-		          VkGen::QueueFamilyIndices _queue_family_indices)
+		          VkGen::QueueFamilyIndices _queue_family_indices, vk::SwapchainKHR _old_swapchain = nullptr)
 		{
 			auto surface_format = ChooseSwapchainSurfaceFormat(_details.formats);
 			auto present_mode   = ChooseSwapchainPresentMode(_details.presentModes);
@@ -62,6 +63,7 @@ namespace VkRes
 			create_info.compositeAlpha = vk::CompositeAlphaFlagBitsKHR::eOpaque;
 			create_info.presentMode    = present_mode;
 			create_info.clipped        = VK_TRUE;
+			create_info.oldSwapchain   = _old_swapchain;
 
 			auto result = _device.createSwapchainKHR(&create_info, nullptr, &m_swapchain);
 
@@ -84,10 +86,9 @@ namespace VkRes
 			return m_swapchain_image_format;
 		}
 
+		// Nothing may still use the images, a retired swapchain is destroyed once its last frame has finished
 		void Destroy(vk::Device _device)
 		{
-			_device.waitIdle();
-
 			for (size_t i = 0 ; i < m_swapchain_image_views.size() ; i++)
 			{
 				_device.destroyImageView(m_swapchain_image_views[i]);
@@ -106,9 +107,8 @@ namespace VkRes
 			return m_swapchain;
 		}
 
-	private:
-
-		[[nodiscard]] vk::SurfaceFormatKHR ChooseSwapchainSurfaceFormat(std::vector<vk::SurfaceFormatKHR> _formats)
+		// Format a swapchain built from these surface formats would use
+		[[nodiscard]] static vk::SurfaceFormatKHR ChooseSwapchainSurfaceFormat(const std::vector<vk::SurfaceFormatKHR>& _formats)
 		{
 			if (_formats.size() == 1 && _formats[0].format == vk::Format::eUndefined)
 			{
@@ -127,6 +127,8 @@ namespace VkRes
 			return _formats[0];
 		}
 
+	private:
+
 		[[nodiscard]] vk::PresentModeKHR ChooseSwapchainPresentMode(std::vector<vk::PresentModeKHR> _present_modes)
 		{
 			vk::PresentModeKHR best_mode = vk::PresentModeKHR::eFifo;
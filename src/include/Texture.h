@@ -27,6 +27,16 @@ namespace VkRes
 			CreateTexture(_device, _physical_device, _cmd, _queue);
 		}
 
+		// ImGui atlas in the given format, eR8Unorm keeps only coverage and reads back as white through the view swizzle
+		Texture(vk::Device         _device,
+		        vk::PhysicalDevice _physical_device,
+		        VkRes::Command     _cmd,
+		        vk::Queue          _queue,
+		        vk::Format         _format) : m_format(_format)
+		{
+			CreateTexture(_device, _physical_device, _cmd, _queue);
+		}
+
 		void Destroy(vk::Device _device)
 		{
 			if (m_texture_image != nullptr)
@@ -53,26 +63,61 @@ namespace VkRes
 			return m_texture_image_view;
 		}
 
+		[[nodiscard]] vk::Image Image() const
+		{
+			return m_texture_image;
+		}
+
+		[[nodiscard]] vk::Format Format() const
+		{
+			return m_format;
+		}
+
+		[[nodiscard]] vk::DeviceSize MemorySize() const
+		{
+			return m_memory_size;
+		}
+
 	private:
 		void CreateTexture(vk::Device _device, vk::PhysicalDevice _physical_device, VkRes::Command _cmd, vk::Queue _queue)
 		{
-			unsigned char* fontData;
-			int            texWidth, texHeight;
+			unsigned char*       fontData;
+			int                  texWidth, texHeight;
+			const bool           alpha_only = m_format == vk::Format::eR8Unorm;
+			vk::ComponentMapping components(vk::ComponentSwizzle::eR, vk::ComponentSwizzle::eG,
+			                                vk::ComponentSwizzle::eB, vk::ComponentSwizzle::eA);
 
 			if constexpr (loader == ETextureLoader::Imgui)
 			{
 				ImGuiIO& io = ImGui::GetIO();
-				io.Fonts->GetTexDataAsRGBA32(&fontData, &texWidth, &texHeight);
+
+				if (alpha_only)
+				{
+					io.Fonts->GetTexDataAsAlpha8(&fontData, &texWidth, &texHeight);
+					components = vk::ComponentMapping(vk::ComponentSwizzle::eOne, vk::ComponentSwizzle::eOne,
+					                                  vk::ComponentSwizzle::eOne, vk::ComponentSwizzle::eR);
+				}
+				else
+				{
+					io.Fonts->GetTexDataAsRGBA32(&fontData, &texWidth, &texHeight);
+				}
 			}
 
-			const vk::DeviceSize upload_size = texWidth * texHeight * 4 * sizeof(char);
-			m_miplevels                      = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
+			const vk::DeviceSize texel_size  = alpha_only ?
+				                                   1 :
+				                                   4;
+			const vk::DeviceSize upload_size = texWidth * texHeight * texel_size * sizeof(char);
+
+			// The atlas is only ever sampled at its base level, so it gets no mip chain
+			m_miplevels = loader == ETextureLoader::Imgui ?
+				              1 :
+				              static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
 
 			const auto image_data = VkRes::CreateImage(_device,
 			                                           _physical_device,
 			                                           texWidth,
 			                                           texHeight,
-			                                           vk::Format::eR8G8B8A8Unorm,
+			                                           m_format,
 			                                           m_miplevels,
 			                                           vk::SampleCountFlagBits::e1,
 			                                           vk::ImageTiling::eOptimal,
@@ -86,9 +131,12 @@ namespace VkRes
 
 			m_texture_image_view = VkRes::CreateImageView(_device,
 			                                              m_texture_image,
-			                                              vk::Format::eR8G8B8A8Unorm,
+			                                              m_format,
 			                                              vk::ImageAspectFlagBits::eColor,
-			                                              1);
+			                                              1,
+			                                              components);
+
+			m_memory_size = _device.getImageMemoryRequirements(m_texture_image).size;
 
 			const auto buffer_data = VkRes::CreateBuffer(_device,
 			                                             _physical_device, upload_size,
@@ -119,7 +167,7 @@ namespace VkRes
 			{
 				VkRes::TransitionImageLayout(cmd_buffer,
 				                             m_texture_image,
-				                             vk::Format::eR8G8B8A8Unorm,
+				                             m_format,
 				                             vk::ImageLayout::eUndefined,
 				                             vk::ImageLayout::eTransferDstOptimal,
 				                             m_miplevels);
@@ -142,7 +190,7 @@ namespace VkRes
 
 				VkRes::TransitionImageLayout(cmd_buffer,
 				                             m_texture_image,
-				                             vk::Format::eR8G8B8A8Unorm,
+				                             m_format,
 				                             vk::ImageLayout::eTransferDstOptimal,
 				                             vk::ImageLayout::eShaderReadOnlyOptimal,
 				                             1);
@@ -155,7 +203,7 @@ namespace VkRes
 
 			if constexpr (loader != ETextureLoader::Imgui)
 			{
-				GenerateMipMaps(_device, _physical_device, _cmd, _queue, vk::Format::eR8G8B8A8Unorm, texWidth, texHeight);
+				GenerateMipMaps(_device, _physical_device, _cmd, _queue, m_format, texWidth, texHeight);
 			}
 		}
 
@@ -305,7 +353,9 @@ namespace VkRes
 		vk::DeviceMemory m_texture_image_memory;
 		vk::ImageView    m_texture_image_view;
 
-		uint32_t m_miplevels;
+		uint32_t       m_miplevels;
+		vk::Format     m_format      = vk::Format::eR8G8B8A8Unorm;
+		vk::DeviceSize m_memory_size = 0;
 
 		vk::DescriptorSetLayoutBinding m_descriptor_set_layout_binding;
 		vk::DescriptorSet              m_descriptor;
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small fixed set of worker threads for data parallel loops. The calling thread joins in
+// on every ParallelFor, so a pool of N workers runs N + 1 items at a time.
+class ThreadPool
+{
+public:
+	explicit ThreadPool(uint32_t _worker_count);
+
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// Calls _func(i) for every i in [0, _count) and returns once all of them have finished
+	void ParallelFor(uint32_t _count, const std::function<void(uint32_t)>& _func);
+
+	[[nodiscard]] uint32_t WorkerCount() const
+	{
+		return static_cast<uint32_t>(m_workers.size());
+	}
+
+	// Leaves one core for the main thread, and never more workers than a UI upload can use
+	static uint32_t DefaultWorkerCount(uint32_t _max = 4);
+
+private:
+	void WorkerLoop();
+
+	void RunItems();
+
+	std::vector<std::thread>             m_workers;
+	std::mutex                           m_mutex;
+	std::condition_variable              m_wake;
+	std::condition_variable              m_done;
+	const std::function<void(uint32_t)>* m_func       = nullptr;
+	std::atomic<uint32_t>                m_next       = 0;
+	uint32_t                             m_count      = 0;
+	uint32_t                             m_active     = 0;
+	uint64_t                             m_generation = 0;
+	bool                                 m_stop       = false;
+};
@@ -2,6 +2,13 @@
 
 #include "VulkanObjects.h"
 #include "Settings.h"
+#include "ThreadPool.h"
+#include "JobSystem.h"
+#include "GlyphCache.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 class UI
 {
@@ -10,36 +17,228 @@ public:
 	{
 		float xScale, yScale;
 		float xTrans, yTrans;
-	}         UIPushConstants;
+	};
 
 	struct UIUBOData
 	{
 		float x, y, z, w; // dummy
 	}         UIDemoUBOData;
 
+	struct FrameStats
+	{
+		uint64_t bytes_uploaded  = 0;
+		uint64_t bytes_skipped   = 0;
+		uint32_t lists_uploaded  = 0;
+		uint32_t lists_skipped   = 0;
+		uint32_t draw_commands   = 0;
+		uint32_t culled_commands = 0;
+		uint32_t draw_calls      = 0;
+		uint64_t damage_pixels   = 0;
+	};
+
 	UI() = default;
 
 	void Destroy(vk::Device);
 
 	void Init(uint32_t, uint32_t, GLFWwindow*);
 
+	// The UI is drawn in the given subpass of the pass, which has to run at the given sample count
 	void LoadResources(vk::Device             , vk::PhysicalDevice,
 	                   std::string_view       , VkRes::Command    ,
 	                   vk::RenderPass         , vk::Queue         ,
-	                   vk::SampleCountFlagBits);
+	                   vk::SampleCountFlagBits, uint32_t          ,
+	                   uint32_t);
+
+	// _input is false when nothing arrived since the last frame, idle mode then keeps the time driven text as it was
+	void PrepNextFrame(float, float, bool);
+
+	// Idle mode found nothing changed and skipped the frame, counted for the stats window
+	void FrameSkipped()
+	{
+		++m_frames_skipped;
+	}
+
+	// Copies the frame PrepNextFrame built into a snapshot the render thread can take. Only call once the render
+	// thread took the previous one
+	void PublishFrame();
+
+	// Render thread, makes the published snapshot the one Update and the draws read. False if there is none
+	bool TakeFrame();
 
-	void PrepNextFrame(float, float);
+	// Uploads the snapshot taken by TakeFrame
+	void Update(vk::Device, vk::PhysicalDevice, uint32_t);
 
-	void Update(vk::Device, vk::PhysicalDevice);
+	// Copies this frame's new glyphs into the atlas and, in staged mode, the changed ranges to device local memory.
+	// Record outside the render pass
+	void RecordUpload(vk::CommandBuffer) const;
+
+	// Redraws the damaged part of the cached layer. Record outside the render pass, before the UI's secondary executes
+	void RecordLayer(vk::CommandBuffer);
 
 	void Draw(VkRes::Command, int);
 
+	// Number of secondaries Draw's batches are split into for parallel recording, between 1 and the given maximum
+	[[nodiscard]] uint32_t DrawChunkCount(uint32_t) const;
+
+	// Records one of DrawChunkCount's chunks, executing all of them in order draws what Draw does.
+	// Safe to call for different chunks from several threads once Update has returned
+	void DrawChunk(vk::CommandBuffer, uint32_t, uint32_t);
+
+	// Makes an image usable as an ImTextureID. The view must stay valid and in eShaderReadOnlyOptimal until
+	// UnregisterTexture, a null sampler uses the UI's linear clamp sampler
+	ImTextureID RegisterTexture(vk::Device, vk::ImageView, vk::Sampler = nullptr);
+
+	void UnregisterTexture(ImTextureID);
+
+	// Released texture slots are handed back through the scheduler once the GPU has retired every frame using them
+	void SetScheduler(VkRes::FrameScheduler*);
+
+	// Font used by the dynamic glyph mode, returns false and keeps ImGui's default font if the file cannot be read.
+	// The atlas reserves room for the glyph budget on top of the baked ranges
+	bool SetDynamicFont(const std::string&, float, uint32_t = GlyphCache::k_default_glyph_budget);
+
+	// Queues every character of a UTF-8 string for rasterization ahead of use, drawn text is requested on its own
+	void RequestGlyphs(const char*);
+
+	// Forgets what the ring slots hold, for when a recorded upload may never have been submitted
+	void InvalidateUploads();
+
 	void Recreate(vk::Device, uint32_t, uint32_t, GLFWwindow*);
 
+	// Stage timings of the last frame graph for the pipeline window, the index is the thread that runs the graph.
+	// Safe to call while the next frame is being built
+	void SetPipelineTimings(const std::vector<JobSystem::Timing>&, uint32_t);
+
+	// Identifies everything UI::Draw would record for the current frame
+	[[nodiscard]] uint64_t DrawDataHash() const
+	{
+		return m_cached_layer ?
+			       m_composite_hash :
+			       m_draw_hash;
+	}
+
+	// Identifies what the current frame looks like, independent of the frame slot it is uploaded to.
+	// Only computed while the idle mode is on, zero otherwise
+	[[nodiscard]] uint64_t ContentHash() const
+	{
+		return m_content_hash;
+	}
+
+	// Part of the screen whose UI changed since the previous frame, all of it after InvalidateUploads.
+	// Empty if nothing changed
+	[[nodiscard]] const vk::Rect2D& Damage() const
+	{
+		return m_damage;
+	}
+
 private:
 
+	// What was last written into a ring slot for one draw list
+	struct UploadRecord
+	{
+		uint64_t hash       = 0;
+		uint32_t vtx_offset = 0;
+		uint32_t idx_offset = 0;
+		uint32_t vtx_count  = 0;
+		uint32_t idx_count  = 0;
+
+		bool operator==(const UploadRecord& _other) const
+		{
+			return hash == _other.hash &&
+				vtx_offset == _other.vtx_offset && idx_offset == _other.idx_offset &&
+				vtx_count == _other.vtx_count && idx_count == _other.idx_count;
+		}
+	};
+
+	// One registered ImTextureID, the id is the index into m_textures
+	struct TextureEntry
+	{
+		vk::ImageView     view;
+		vk::Sampler       sampler;
+		vk::DescriptorSet set; // own set when not bindless
+		bool              used    = false;
+		bool              retired = true; // no submitted frame still samples it
+	};
+
+	struct BenchmarkResult
+	{
+		uint32_t list_count;
+		double   serial_gbps;
+		double   parallel_gbps;
+		uint32_t workers;
+	};
+
+	// A built frame as the render thread sees it. The lists are owned copies, so ImGui can start the next frame
+	// while this one is uploaded and recorded
+	struct FrameSnapshot
+	{
+		ImDrawData                               draw_data;
+		std::vector<std::unique_ptr<ImDrawList>> lists;
+		std::vector<ImDrawList*>                 list_pointers;
+		std::vector<GlyphCache::Rect>            glyph_rects;
+		std::vector<uint8_t>                     glyph_pixels; // rows of every rect, tightly packed
+		bool                                     parallel_upload = false;
+		bool                                     run_benchmark   = false;
+		std::vector<std::unique_ptr<ImDrawList>> benchmark_lists; // synthetic lists, only present with run_benchmark
+	};
+
+	// Consecutive ImDrawCmds merged into a single indexed draw
+	struct DrawBatch
+	{
+		vk::Rect2D  scissor;
+		ImTextureID texture;
+		uint32_t    first_index;
+		int32_t     vertex_offset;
+		uint32_t    index_count;
+	};
+
+	// One draw list as it was drawn last frame
+	struct DamageList
+	{
+		const char* owner;
+		uint64_t    hash;
+		vk::Rect2D  bounds;
+	};
+
 	void UpdateSettings();
 
+	void DrawPipelineTimings() const;
+
+	// Hands the render thread's stats to the stats window
+	void PublishStats();
+
+	// Hashes every list and writes the changed ones to _vtx_dst / _idx_dst, optionally on the upload pool
+	void UploadDrawLists(ImDrawList* const*, int, uint8_t*, uint8_t*, std::vector<UploadRecord>&, bool);
+
+	void RunUploadBenchmark(const std::vector<std::unique_ptr<ImDrawList>>&);
+
+	void BuildDrawBatches(const ImDrawData*);
+
+	void WriteIndirectDraws(vk::Device, vk::PhysicalDevice);
+
+	void RecordDraw(vk::CommandBuffer, const vk::Rect2D&, uint32_t, uint32_t);
+
+	void DrawDirect(vk::CommandBuffer, const vk::Rect2D&, uint32_t, uint32_t);
+
+	[[nodiscard]] uint32_t TextureSlot(ImTextureID) const;
+
+	[[nodiscard]] uint32_t TextureRun(uint32_t) const;
+
+	void WriteTextureDescriptor(vk::Device, uint32_t);
+
+	void DrawIndirect(vk::CommandBuffer, const vk::Rect2D&, uint32_t, uint32_t);
+
+	void CreateLayer(vk::Device, vk::PhysicalDevice, std::string_view, VkRes::Command, vk::RenderPass, vk::Queue,
+	                 vk::SampleCountFlagBits, uint32_t);
+
+	void UpdateDamage(const ImDrawData*);
+
+	void DrawComposite(vk::CommandBuffer);
+
+	void StageGlyphs(vk::Device, vk::PhysicalDevice);
+
+	void RecordGlyphUpload(vk::CommandBuffer) const;
+
 	Settings local_settings;
 	bool     load_frame = true;
 
@@ -47,14 +246,102 @@ private:
 	vk::DescriptorSetLayout                      m_desc_set_layout;
 	vk::DescriptorSet                            m_desc_set;
 	VkRes::GraphicsPipeline                      m_pipeline;
-	VkRes::Buffer                                m_vertex_buffer;
-	VkRes::Buffer                                m_index_buffer;
+	VkRes::RingBuffer                            m_vertex_buffer;
+	VkRes::RingBuffer                            m_index_buffer;
 	VkRes::Shader                                m_vert;
 	VkRes::Shader                                m_frag;
 	VkRes::Sampler<vk::Filter::eLinear>          m_sampler;
 	VkRes::Texture<VkRes::ETextureLoader::Imgui> m_font_tex;
 	float                                        m_width;
 	float                                        m_height;
+	uint32_t                                     m_frame_index  = 0;
 	int32_t                                      m_vertex_count = 0;
 	int32_t                                      m_index_count  = 0;
+	std::vector<std::vector<UploadRecord>>       m_upload_records;
+	std::vector<VkRes::RingBuffer::Range>        m_vertex_ranges;
+	std::vector<VkRes::RingBuffer::Range>        m_index_ranges;
+	std::vector<DrawBatch>                       m_draw_batches;
+	FrameStats                                   m_stats;
+	uint64_t                                     m_draw_hash       = 0;
+	uint64_t                                     m_content_hash    = 0;
+	bool                                         m_packed_vertices = false;
+	uint32_t                                     m_vertex_stride   = sizeof(ImDrawVert);
+	bool                                         m_parallel_upload = false;
+	bool                                         m_staged_upload   = false;
+	VkRes::RingBuffer                            m_device_vertex_buffer;
+	VkRes::RingBuffer                            m_device_index_buffer;
+	std::unique_ptr<ThreadPool>                  m_upload_pool;
+	std::vector<UploadRecord>                    m_pending_records;
+	std::vector<uint8_t>                         m_list_uploaded;
+	std::vector<BenchmarkResult>                 m_benchmark_results;
+
+	// Indirect mode, every batch becomes one VkDrawIndexedIndirectCommand and clipping moves to the shader
+	bool                                         m_indirect_draw           = false;
+	bool                                         m_multi_draw_indirect     = false;
+	uint32_t                                     m_max_draw_indirect_count = 1;
+	vk::DescriptorSetLayout                      m_draw_set_layout;
+	std::vector<vk::DescriptorSet>               m_draw_sets;
+	std::vector<uint32_t>                        m_draw_set_generations;
+	VkRes::RingBuffer                            m_indirect_buffer;
+	VkRes::RingBuffer                            m_draw_data_buffer;
+
+	// Bindless mode, m_desc_set holds every texture and draws pick theirs by slot
+	bool                                         m_bindless           = false;
+	std::vector<TextureEntry>                    m_textures;
+	uint32_t                                     m_texture_generation = 0;
+	VkRes::FrameScheduler*                       m_scheduler          = nullptr;
+	ImTextureID                                  m_atlas_preview      = nullptr;
+
+	// Dynamic glyph mode, glyphs outside the baked ranges are rasterized on first use and copied into the atlas
+	bool                                         m_dynamic_glyphs = false;
+	GlyphCache                                   m_glyph_cache;
+	VkRes::RingBuffer                            m_glyph_buffer;
+	std::vector<vk::BufferImageCopy>             m_glyph_copies;
+	bool                                         m_sdf_text  = false;
+	float                                        m_text_zoom = 1.0f;
+
+	// Cached layer mode, the UI lives in its own image and only the rect covering changed lists is redrawn
+	bool                                         m_cached_layer = false;
+	VkRes::RenderTarget                          m_layer;
+	VkRes::RenderPass                            m_layer_pass;
+	VkRes::FrameBuffer                           m_layer_framebuffer;
+	vk::DescriptorSetLayout                      m_layer_set_layout;
+	vk::DescriptorSet                            m_layer_set;
+	VkRes::Shader                                m_composite_vert;
+	VkRes::Shader                                m_composite_frag;
+	VkRes::GraphicsPipeline                      m_composite_pipeline;
+	uint64_t                                     m_composite_hash = 0;
+
+	// Damage tracking, the rect of the screen whose UI pixels changed since the previous frame
+	std::vector<DamageList>                      m_damage_lists;
+	vk::Rect2D                                   m_damage;
+	bool                                         m_full_damage               = true;
+	uint32_t                                     m_damage_texture_generation = 0;
+
+	// Last frame graph, shown so the overlap of UI building and rendering can be checked
+	std::vector<JobSystem::Timing>               m_pipeline_timings;
+	uint32_t                                     m_pipeline_graph_thread = 0;
+	double                                       m_build_ms              = 0.0;
+	double                                       m_publish_ms            = 0.0;
+
+	// Double buffered snapshots, the main thread fills one while the render thread reads the other.
+	// m_shared_mutex guards the pending flag and the published results below
+	FrameSnapshot                                m_snapshots[2];
+	uint32_t                                     m_build_snapshot   = 0;
+	uint32_t                                     m_render_snapshot  = 1;
+	bool                                         m_snapshot_pending = false;
+	std::mutex                                   m_shared_mutex;
+	FrameStats                                   m_published_stats;
+	bool                                         m_benchmark_requested = false;
+	std::atomic<bool>                            m_glyph_reupload      = false;
+
+	// What the main thread's windows show, copied from the render thread's results once per frame
+	FrameStats                                   m_shown_stats;
+	std::vector<BenchmarkResult>                 m_shown_benchmarks;
+	std::vector<JobSystem::Timing>               m_shown_timings;
+	float                                        m_shown_time       = 0.0f;
+	double                                       m_shown_build_ms   = 0.0;
+	double                                       m_shown_publish_ms = 0.0;
+	uint64_t                                     m_shown_skipped    = 0;
+	uint64_t                                     m_frames_skipped   = 0;
 };
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "include\imgui-1.70\imgui.h"
+
+// Compact 12 byte replacement for ImDrawVert (20 bytes), decoded by the vertex fetch itself:
+// pos is R16G16Snorm holding pixels in 1 / k_position_subpixels steps, uv is R16G16Unorm
+// and col is passed through untouched
+struct UIPackedVertex
+{
+	int16_t  pos[2];
+	uint16_t uv[2];
+	uint32_t col;
+};
+
+static_assert(sizeof(UIPackedVertex) == 12, "UIPackedVertex must stay tightly packed");
+
+namespace UIVertex
+{
+	// Quarter pixel precision covers +-8191 pixels, enough for any surface we present to
+	constexpr float k_position_subpixels = 4.0f;
+
+	// Multiplier that turns a decoded snorm position back into pixels, folded into the push constant scale
+	constexpr float k_position_decode = 32767.0f / k_position_subpixels;
+
+	// Converts _count vertices, positions outside the representable range are clamped
+	void Pack(const ImDrawVert* _src, UIPackedVertex* _dst, size_t _count);
+}
@@ -106,6 +106,8 @@ namespace VkGen
 
 		VkBool32 CheckDeviceExtensionSupport(const vk::PhysicalDevice);
 
+		bool DeviceExtensionSupported(const vk::PhysicalDevice, const char*) const;
+
 		SwapChainSupportDetails QuerySwapChainSupport(const vk::PhysicalDevice);
 
 		void LogInitState();
@@ -206,6 +208,38 @@ namespace VkGen
 			return m_queue_family_indices;
 		}
 
+		const vk::PhysicalDeviceFeatures& EnabledFeatures() const
+		{
+			return m_enabled_features;
+		}
+
+		const vk::PhysicalDeviceDescriptorIndexingFeaturesEXT& DescriptorIndexingFeatures() const
+		{
+			return m_descriptor_indexing_features;
+		}
+
+		const vk::PhysicalDeviceDescriptorIndexingPropertiesEXT& DescriptorIndexingProperties() const
+		{
+			return m_descriptor_indexing_properties;
+		}
+
+		const vk::PhysicalDeviceTimelineSemaphoreFeaturesKHR& TimelineSemaphoreFeatures() const
+		{
+			return m_timeline_semaphore_features;
+		}
+
+		bool DeviceExtensionEnabled(const char* _extension) const
+		{
+			for (const char* extension : m_enabled_device_extensions)
+			{
+				if (strcmp(extension, _extension) == 0)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
 		/* public members */
 	public:
 
@@ -215,8 +249,14 @@ namespace VkGen
 		vk::PhysicalDevice m_physical_device;
 		vk::Device         m_device;
 
-		SwapChainSupportDetails m_swapchain_support;
-		QueueFamilyIndices      m_queue_family_indices;
+		SwapChainSupportDetails                           m_swapchain_support;
+		QueueFamilyIndices                                m_queue_family_indices;
+		vk::PhysicalDeviceFeatures                        m_enabled_features;
+		vk::PhysicalDeviceDescriptorIndexingFeaturesEXT   m_descriptor_indexing_features;
+		vk::PhysicalDeviceDescriptorIndexingPropertiesEXT m_descriptor_indexing_properties;
+		vk::PhysicalDeviceTimelineSemaphoreFeaturesKHR    m_timeline_semaphore_features;
+		std::vector<const char*>                          m_enabled_device_extensions;
+		uint32_t                                          m_instance_version = VK_API_VERSION_1_0;
 
 		// potentially passed in via caller and not stored with VkGenerator
 		vk::Queue m_graphics_queue;
@@ -247,6 +287,15 @@ namespace VkGen
 		{
 			VK_KHR_SWAPCHAIN_EXTENSION_NAME
 		};
+
+		// enabled when present, callers check DeviceExtensionEnabled before relying on them
+		const std::vector<const char*> m_optional_device_extensions =
+		{
+			VK_KHR_MAINTENANCE3_EXTENSION_NAME,
+			VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME,
+			VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME,
+			VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME
+		};
 	};
 }
 
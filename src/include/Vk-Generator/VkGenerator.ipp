@@ -168,6 +168,19 @@ namespace VkGen
 		return requiredExtensions.empty();
 	}
 
+	inline bool VkGenerator::DeviceExtensionSupported(const vk::PhysicalDevice _physical_device, const char* _extension) const
+	{
+		for (const auto& extension : _physical_device.enumerateDeviceExtensionProperties())
+		{
+			if (strcmp(extension.extensionName, _extension) == 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
 	inline SwapChainSupportDetails VkGenerator::QuerySwapChainSupport(const vk::PhysicalDevice _physical_device)
 	{
 		SwapChainSupportDetails details;
@@ -393,13 +406,27 @@ namespace VkGen
 
 		const auto extensions = GetRequiredExtensions();
 
+		// a 1.0 loader has no vkEnumerateInstanceVersion and rejects any apiVersion above 1.0
+		const auto enumerate_instance_version = reinterpret_cast<PFN_vkEnumerateInstanceVersion>(
+			vkGetInstanceProcAddr(nullptr, "vkEnumerateInstanceVersion"));
+
+		m_instance_version = VK_API_VERSION_1_0;
+		if (enumerate_instance_version != nullptr)
+		{
+			uint32_t version = VK_API_VERSION_1_0;
+			if (enumerate_instance_version(&version) == VK_SUCCESS && version >= VK_API_VERSION_1_1)
+			{
+				m_instance_version = VK_API_VERSION_1_1;
+			}
+		}
+
 		vk::ApplicationInfo app_info =
 		{
 			"Insert App Name",
 			1,
 			"Insert Engine Name",
 			1,
-			VK_API_VERSION_1_0
+			m_instance_version
 		};
 
 		vk::InstanceCreateInfo create_info =
@@ -460,11 +487,82 @@ namespace VkGen
 			);
 		}
 
+		const vk::PhysicalDeviceFeatures supported_features = m_physical_device.getFeatures();
+
 		vk::PhysicalDeviceFeatures device_features = {};
 		device_features.samplerAnisotropy          = VK_TRUE;
 		device_features.fillModeNonSolid           = VK_TRUE;
 		device_features.fragmentStoresAndAtomics   = VK_TRUE;
 
+		// optional, enabled whenever the device has them
+		device_features.multiDrawIndirect         = supported_features.multiDrawIndirect;
+		device_features.drawIndirectFirstInstance = supported_features.drawIndirectFirstInstance;
+
+		m_enabled_features = device_features;
+
+		m_enabled_device_extensions = m_device_extensions;
+		for (const char* extension : m_optional_device_extensions)
+		{
+			if (DeviceExtensionSupported(m_physical_device, extension))
+			{
+				m_enabled_device_extensions.push_back(extension);
+			}
+		}
+
+		// extension features are chained through features2, which needs a 1.1 instance and device. The 1.1 entry points
+		// are loaded at runtime, so the executable imports nothing a 1.0 loader lacks and the extensions just stay off
+		const bool features2 = m_instance_version >= VK_API_VERSION_1_1 &&
+			m_physical_device.getProperties().apiVersion >= VK_API_VERSION_1_1;
+
+		const auto get_features2   = features2 ?
+			                             reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2>(
+				                             m_instance.getProcAddr("vkGetPhysicalDeviceFeatures2")) :
+			                             nullptr;
+		const auto get_properties2 = features2 ?
+			                             reinterpret_cast<PFN_vkGetPhysicalDeviceProperties2>(
+				                             m_instance.getProcAddr("vkGetPhysicalDeviceProperties2")) :
+			                             nullptr;
+
+		m_descriptor_indexing_features   = vk::PhysicalDeviceDescriptorIndexingFeaturesEXT{};
+		m_descriptor_indexing_properties = vk::PhysicalDeviceDescriptorIndexingPropertiesEXT{};
+		vk::PhysicalDeviceFeatures2 device_features2 = {device_features};
+
+		if (get_features2 != nullptr && get_properties2 != nullptr &&
+			DeviceExtensionEnabled(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME))
+		{
+			vk::PhysicalDeviceDescriptorIndexingFeaturesEXT indexing  = {};
+			vk::PhysicalDeviceFeatures2                     supported = {};
+			supported.pNext                                           = &indexing;
+			get_features2(m_physical_device, reinterpret_cast<VkPhysicalDeviceFeatures2*>(&supported));
+
+			m_descriptor_indexing_features.shaderSampledImageArrayNonUniformIndexing    = indexing.shaderSampledImageArrayNonUniformIndexing;
+			m_descriptor_indexing_features.descriptorBindingSampledImageUpdateAfterBind = indexing.descriptorBindingSampledImageUpdateAfterBind;
+			m_descriptor_indexing_features.descriptorBindingUpdateUnusedWhilePending    = indexing.descriptorBindingUpdateUnusedWhilePending;
+			m_descriptor_indexing_features.descriptorBindingPartiallyBound              = indexing.descriptorBindingPartiallyBound;
+
+			vk::PhysicalDeviceProperties2 properties = {};
+			properties.pNext                         = &m_descriptor_indexing_properties;
+			get_properties2(m_physical_device, reinterpret_cast<VkPhysicalDeviceProperties2*>(&properties));
+			m_descriptor_indexing_properties.pNext = nullptr;
+
+			device_features2.pNext = &m_descriptor_indexing_features;
+		}
+
+		m_timeline_semaphore_features = vk::PhysicalDeviceTimelineSemaphoreFeaturesKHR{};
+
+		if (get_features2 != nullptr && DeviceExtensionEnabled(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME))
+		{
+			vk::PhysicalDeviceTimelineSemaphoreFeaturesKHR timeline  = {};
+			vk::PhysicalDeviceFeatures2                    supported = {};
+			supported.pNext                                          = &timeline;
+			get_features2(m_physical_device, reinterpret_cast<VkPhysicalDeviceFeatures2*>(&supported));
+
+			m_timeline_semaphore_features.timelineSemaphore = timeline.timelineSemaphore;
+
+			m_timeline_semaphore_features.pNext = device_features2.pNext;
+			device_features2.pNext              = &m_timeline_semaphore_features;
+		}
+
 		vk::DeviceCreateInfo device_create_info =
 		{
 			{},
@@ -476,11 +574,18 @@ namespace VkGen
 			m_validation ?
 				m_validation_layers.data() :
 				nullptr,
-			m_device_extensions.size(),
-			m_device_extensions.data(),
-			&device_features
+			m_enabled_device_extensions.size(),
+			m_enabled_device_extensions.data(),
+			features2 ?
+				nullptr :
+				&device_features
 		};
 
+		if (features2)
+		{
+			device_create_info.pNext = &device_features2;
+		}
+
 		const vk::Result res = m_physical_device.createDevice(&device_create_info, nullptr, &m_device);
 		assert(( "failed to create device", res == vk::Result::eSuccess ));
 
@@ -8,9 +8,14 @@ extern Logger g_Logger;
 
 namespace VkRes
 {
-	[[nodiscard]] static vk::ImageView CreateImageView(vk::Device _device, vk::Image            _image,
-	                                                   vk::Format _format, vk::ImageAspectFlags _aspect_flags,
-	                                                   uint32_t   _mips_level)
+	[[nodiscard]] static vk::ImageView CreateImageView(vk::Device           _device, vk::Image            _image,
+	                                                   vk::Format           _format, vk::ImageAspectFlags _aspect_flags,
+	                                                   uint32_t             _mips_level,
+	                                                   vk::ComponentMapping _components =
+		                                                   vk::ComponentMapping(vk::ComponentSwizzle::eR,
+		                                                                        vk::ComponentSwizzle::eG,
+		                                                                        vk::ComponentSwizzle::eB,
+		                                                                        vk::ComponentSwizzle::eA))
 	{
 		vk::ImageViewCreateInfo create_info =
 		{
@@ -18,8 +23,7 @@ namespace VkRes
 			_image,
 			vk::ImageViewType::e2D,
 			_format,
-			vk::ComponentMapping(vk::ComponentSwizzle::eR, vk::ComponentSwizzle::eG,
-			                     vk::ComponentSwizzle::eB, vk::ComponentSwizzle::eA),
+			_components,
 			vk::ImageSubresourceRange(_aspect_flags, 0, _mips_level, 0, 1)
 		};
 
@@ -178,6 +182,13 @@ namespace VkRes
 			_src_stage = vk::PipelineStageFlagBits::eTopOfPipe;
 			_dst_stage = vk::PipelineStageFlagBits::eColorAttachmentOutput;
 		}
+		else if (_old_layout == vk::ImageLayout::eColorAttachmentOptimal && _new_layout == vk::ImageLayout::eShaderReadOnlyOptimal)
+		{
+			barrier.setSrcAccessMask(vk::AccessFlagBits::eColorAttachmentWrite);
+			barrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+			_src_stage = vk::PipelineStageFlagBits::eColorAttachmentOutput;
+			_dst_stage = vk::PipelineStageFlagBits::eFragmentShader;
+		}
 		else
 		{
 			g_Logger.Error("Unsupported image transition");
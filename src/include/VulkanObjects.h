@@ -2,6 +2,7 @@
 
 #include "Swapchain.h"
 #include "Command.h"
+#include "FrameCommandPools.h"
 #include "RenderTarget.h"
 #include "RenderPass.h"
 #include "FrameBuffer.h"
@@ -9,6 +10,8 @@
 #include "Shader.h"
 #include "Fence.h"
 #include "Semaphore.h"
+#include "FrameScheduler.h"
 #include "Buffer.h"
+#include "RingBuffer.h"
 #include "Sampler.h"
 #include "Texture.h"
\ No newline at end of file